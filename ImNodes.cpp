@@ -25,14 +25,49 @@
 #endif
 
 #include "ImNodes.h"
+#include "ImNodesInternal.h"
 
 #include <imgui_internal.h>
+#include <chrono>
 #include <limits>
+#ifndef IMNODES_NO_THREADS
+#   include <atomic>
+#   include <condition_variable>
+#   include <mutex>
+#   include <thread>
+#   include <vector>
+#endif
+
+// Curve kernels use AVX2 or SSE2 when enabled by compiler flags. Define IMNODES_DISABLE_SIMD to use scalar code only.
+#if !defined(IMNODES_DISABLE_SIMD) && defined(__AVX2__)
+#   define IMNODES_SIMD_AVX2
+#endif
+#if !defined(IMNODES_DISABLE_SIMD) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#   define IMNODES_SIMD_SSE2
+#endif
+#if defined(IMNODES_SIMD_AVX2)
+#   include <immintrin.h>
+#elif defined(IMNODES_SIMD_SSE2)
+#   include <emmintrin.h>
+#endif
 
 namespace ImNodes
 {
 
 CanvasState* gCanvas = nullptr;
+/// Statistics of the canvas that was terminated last.
+CanvasStats gLastCanvasStats{};
+
+/// Allocator functions wrapped by EnableAllocationCounter() and number of allocations made through them.
+struct _AllocationCounter
+{
+    ImGuiMemAllocFunc AllocFunc = nullptr;
+    ImGuiMemFreeFunc FreeFunc = nullptr;
+    void* UserData = nullptr;
+    ImU64 Count = 0;
+    ImU64 Bytes = 0;
+};
+static _AllocationCounter gAllocationCounter;
 
 bool operator ==(const ImVec2& a, const ImVec2& b)
 {
@@ -47,44 +82,622 @@ enum _ImNodesState
     State_Select,
 };
 
+/// Phases of canvas frame whose time is reported in CanvasStats.
+enum _CanvasPhase
+{
+    Phase_BeginCanvas,
+    Phase_Nodes,
+    Phase_Connections,
+    Phase_EndCanvas,
+};
+
+typedef std::chrono::steady_clock _StatsClock;
+
+#ifdef IMNODES_PROFILE_CHROME_TRACE
+/// Profiling zone recorded by the bundled trace backend.
+struct _ProfileEvent
+{
+    const char* Name;
+    /// Start time and duration in microseconds.
+    double Start;
+    double Duration;
+};
+
+struct _ProfileTrace
+{
+    bool Recording = false;
+    _StatsClock::time_point Epoch{};
+    ImVector<_ProfileEvent> Events{};
+};
+
+static _ProfileTrace gProfileTrace;
+
+static double GetProfileTime()
+{
+    return std::chrono::duration<double, std::micro>(_StatsClock::now() - gProfileTrace.Epoch).count();
+}
+
+void BeginProfileTrace()
+{
+    gProfileTrace.Recording = true;
+    gProfileTrace.Epoch = _StatsClock::now();
+    gProfileTrace.Events.resize(0);
+}
+
+bool EndProfileTrace(const char* path)
+{
+    IM_ASSERT(path != nullptr);
+    gProfileTrace.Recording = false;
+
+    FILE* file = fopen(path, "wb");
+    if (file == nullptr)
+        return false;
+
+    fputs("{\"traceEvents\":[", file);
+    for (int i = 0; i < gProfileTrace.Events.Size; i++)
+    {
+        const _ProfileEvent& event = gProfileTrace.Events[i];
+        fprintf(file, "%s\n{\"name\":\"%s\",\"cat\":\"ImNodes\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":1}",
+            i > 0 ? "," : "", event.Name, event.Start, event.Duration);
+    }
+    fputs("\n]}\n", file);
+    gProfileTrace.Events.clear();
+    return fclose(file) == 0;
+}
+
+ProfileScope::ProfileScope(const char* name)
+{
+    Name = name;
+    Start = gProfileTrace.Recording ? GetProfileTime() : -1.0;
+}
+
+ProfileScope::~ProfileScope()
+{
+    if (gProfileTrace.Recording && Start >= 0)
+        gProfileTrace.Events.push_back({Name, Start, GetProfileTime() - Start});
+}
+#endif
+
 /// Struct containing information about connection source node and slot.
 struct _DragConnectionPayload
 {
     /// Node id where connection started.
     void* NodeId = nullptr;
-    /// Source slot name.
+    /// Source slot id.
+    ImGuiID SlotId = 0;
+    /// Source slot name. May be null when slot was created with an integer id.
     const char* SlotTitle = nullptr;
     /// Source slot kind.
     int SlotKind = 0;
 };
 
+/// Prefix of drag-drop payload type of pending connection. Type name is suffixed with slot kind.
+static const char ConnectionPayloadPrefix[] = "new-node-connection-";
+
+/// Drag-drop payload type name of connections starting at slots of specific kind.
+struct _PayloadType
+{
+    /// Slot kind.
+    int Kind;
+    /// Payload type name.
+    char Name[32];
+};
+
+ImGuiID MakeNodeDataID(void* node_id)
+{
+    return ImHashData(&node_id, sizeof(node_id));
+}
+
+/// Returns id of slot record in _CanvasStateImpl::Slots.
+ImGuiID MakeSlotRecordID(void* node_id, ImGuiID slot_id, bool input_slot)
+{
+    ImGuiID record_id = ImHashData(&slot_id, sizeof(slot_id), MakeNodeDataID(node_id));
+    if (input_slot)
+    {
+        // Ensure that input and output slots with same id have different record ids.
+        record_id ^= ~0U;
+    }
+    // Id 0 marks empty slot record.
+    return record_id != 0 ? record_id : 1;
+}
+
 /// Node-slot combination.
 struct _IgnoreSlot
 {
     /// Node id.
     void* NodeId = nullptr;
-    /// Slot name.
-    const char* SlotName = nullptr;
-    /// Slot kind. Not actual slot kind, but +1 or -1. Used to determine if slot is input or output.
-    int SlotKind = 0;
+    /// Slot id.
+    ImGuiID SlotId = 0;
+    /// Flag indicating that slot is an input slot.
+    bool InputSlot = false;
 
-    /// Equality operator, required by ImVector.
     bool operator==(const _IgnoreSlot& other) const
     {
-        if (NodeId != other.NodeId || SlotKind != other.SlotKind)
+        return NodeId == other.NodeId && SlotId == other.SlotId && InputSlot == other.InputSlot;
+    }
+};
+
+/// Open addressing hash set of node-slot combinations with linear probing. Slots are hashed by id of their slot record,
+/// see MakeSlotRecordID().
+struct _IgnoreSlotSet
+{
+    /// Table of entries, size is always zero or a power of two. Empty entries have null node id.
+    ImVector<_IgnoreSlot> Entries{};
+    /// Number of non-empty entries.
+    int Count = 0;
+
+    bool Contains(const _IgnoreSlot& slot, ImGuiID hash) const
+    {
+        if (Count == 0)
             return false;
 
-        if (SlotName != nullptr && other.SlotName != nullptr)
-            return strcmp(SlotName, other.SlotName) == 0;
+        ImU32 mask = (ImU32)Entries.Size - 1;
+        for (ImU32 i = hash & mask;; i = (i + 1) & mask)
+        {
+            const _IgnoreSlot& entry = Entries.Data[i];
+            if (entry == slot)
+                return true;
+            if (entry.NodeId == nullptr)
+                return false;
+        }
+    }
+
+    void Add(const _IgnoreSlot& slot, ImGuiID hash)
+    {
+        IM_ASSERT(slot.NodeId != nullptr);
+        if (Contains(slot, hash))
+            return;
 
-        return other.SlotName == SlotName;
+        // Keep load factor under 50%. Entries are rehashed by their record id.
+        if ((Count + 1) * 2 > Entries.Size)
+        {
+            ImVector<_IgnoreSlot> old_entries;
+            old_entries.swap(Entries);
+            Entries.resize(ImMax(old_entries.Size * 2, 16), _IgnoreSlot{});
+            Count = 0;
+            for (const _IgnoreSlot& entry : old_entries)
+            {
+                if (entry.NodeId != nullptr)
+                    Insert(entry, MakeSlotRecordID(entry.NodeId, entry.SlotId, entry.InputSlot));
+            }
+        }
+        Insert(slot, hash);
     }
+
+    void Clear()
+    {
+        if (Count == 0)
+            return;
+        for (_IgnoreSlot& entry : Entries)
+            entry = _IgnoreSlot{};
+        Count = 0;
+    }
+
+    void Insert(const _IgnoreSlot& slot, ImGuiID hash)
+    {
+        ImU32 mask = (ImU32)Entries.Size - 1;
+        ImU32 i = hash & mask;
+        while (Entries.Data[i].NodeId != nullptr)
+            i = (i + 1) & mask;
+        Entries.Data[i] = slot;
+        Count++;
+    }
+};
+
+/// Node geometry remembered from the previous frame.
+struct _CachedNode
+{
+    /// User-provided unique node id.
+    void* Id = nullptr;
+    /// ImGui item id of the node.
+    ImGuiID ItemId = 0;
+    /// Node position in canvas as of last EndNode() call.
+    ImVec2 Pos{};
+    /// Node rect relative to the node position, unscaled by zoom. Empty until node is rendered for the first time.
+    ImRect Rect{};
+    /// Order in which node was submitted on the last frame. Nodes submitted later are rendered on top.
+    int Order = 0;
+    /// Last frame on which node was found to be inside of selection rect.
+    int SelectionFrame = -1;
+    /// Last frame on which node was submitted.
+    int LastFrame = -1;
+    /// Last frame on which node was submitted and not culled.
+    int LastRenderedFrame = -1;
+    /// Node selection status before current mouse click. Used for appending to or subtracting from selection.
+    bool PrevSelected = false;
+    /// Node selection status as of last EndNode() call.
+    bool Selected = false;
+
+    /// Returns node rect in canvas coordinates.
+    ImRect GetCanvasRect() const { return {Pos + Rect.Min, Pos + Rect.Max}; }
+};
+
+/// Item index paired with a hash of grid cell it overlaps.
+struct _SpatialGridEntry
+{
+    ImU32 CellHash;
+    int Index;
+};
+
+/// Spatial hash of item rects. Items are inserted during the frame and become queryable once index is built.
+struct _SpatialGrid
+{
+    /// Size of a square grid cell used for inserting items.
+    float CellSize = 128.0f;
+    /// Size of a square grid cell of built index.
+    float IndexCellSize = 128.0f;
+    /// Cell-item pairs collected on current frame.
+    ImVector<_SpatialGridEntry> Pending{};
+    /// Offset of first entry of every bucket in `Entries`. Has one extra element at the end.
+    ImVector<int> Buckets{};
+    /// Item indices sorted by bucket.
+    ImVector<int> Entries{};
+    /// Id of last query every item was returned from. Used to skip duplicates of items spanning multiple cells.
+    ImVector<int> QueryIds{};
+    int QueryId = 0;
+    /// Total extent of items inserted on current frame. Used to pick a cell size for the next frame.
+    float ExtentSum = 0.0f;
+    int ExtentCount = 0;
+
+    static ImU32 HashCell(int x, int y) { return (ImU32)x * 73856093u ^ (ImU32)y * 19349663u; }
+
+    static int ToCell(float v, float cell_size)
+    {
+        return (int)floorf(ImClamp(v / cell_size, -1e6f, 1e6f));
+    }
+
+    /// Starts collecting items for the next index. Previously built index remains queryable until Build() is called.
+    void Clear()
+    {
+        if (ExtentCount > 0)
+            CellSize = ImMax(ExtentSum / (float)ExtentCount, 16.0f);
+        ExtentSum = 0.0f;
+        ExtentCount = 0;
+        Pending.resize(0);
+    }
+
+    void Insert(int index, const ImRect& rect)
+    {
+        ExtentSum += ImMax(rect.GetWidth(), rect.GetHeight());
+        ExtentCount++;
+        int x0 = ToCell(rect.Min.x, CellSize), x1 = ToCell(rect.Max.x, CellSize);
+        int y0 = ToCell(rect.Min.y, CellSize), y1 = ToCell(rect.Max.y, CellSize);
+        for (int y = y0; y <= y1; y++)
+        {
+            for (int x = x0; x <= x1; x++)
+                Pending.push_back({HashCell(x, y), index});
+        }
+        if (index >= QueryIds.Size)
+            QueryIds.resize(index + 1, 0);
+    }
+
+    /// Sorts collected entries into buckets by counting sort.
+    void Build()
+    {
+        int bucket_count = ImUpperPowerOfTwo(ImMax(Pending.Size, 64));
+        ImU32 mask = (ImU32)bucket_count - 1;
+        Buckets.resize(bucket_count + 1);
+        memset(Buckets.Data, 0, Buckets.size_in_bytes());
+        for (const _SpatialGridEntry& entry : Pending)
+            Buckets[(int)(entry.CellHash & mask) + 1]++;
+        for (int i = 0; i < bucket_count; i++)
+            Buckets[i + 1] += Buckets[i];
+
+        // End of every bucket is used as insertion cursor, after scatter Buckets[i + 1] holds start of bucket i.
+        Entries.resize(Pending.Size);
+        for (int i = Pending.Size - 1; i >= 0; i--)
+            Entries[--Buckets[(int)(Pending[i].CellHash & mask) + 1]] = Pending[i].Index;
+        for (int i = 0; i < bucket_count; i++)
+            Buckets[i] = Buckets[i + 1];
+        Buckets[bucket_count] = Entries.Size;
+        IndexCellSize = CellSize;
+    }
+
+    /// Appends indices of items from cells overlapping `rect` to `out`. Returned items are not guaranteed to overlap
+    /// `rect`, caller should test actual item rects.
+    void Query(const ImRect& rect, ImVector<int>& out)
+    {
+        if (Buckets.Size < 2)
+            return;
+
+        QueryId++;
+        int bucket_count = Buckets.Size - 1;
+        ImU32 mask = (ImU32)bucket_count - 1;
+        int x0 = ToCell(rect.Min.x, IndexCellSize), x1 = ToCell(rect.Max.x, IndexCellSize);
+        int y0 = ToCell(rect.Min.y, IndexCellSize), y1 = ToCell(rect.Max.y, IndexCellSize);
+        if ((ImS64)(x1 - x0 + 1) * (y1 - y0 + 1) >= bucket_count)
+        {
+            // Query covers more cells than there are buckets, visiting every entry is cheaper.
+            AppendUnique(0, Entries.Size, out);
+            return;
+        }
+        for (int y = y0; y <= y1; y++)
+        {
+            for (int x = x0; x <= x1; x++)
+            {
+                int bucket = (int)(HashCell(x, y) & mask);
+                AppendUnique(Buckets[bucket], Buckets[bucket + 1], out);
+            }
+        }
+    }
+
+    void AppendUnique(int begin, int end, ImVector<int>& out)
+    {
+        for (int i = begin; i < end; i++)
+        {
+            int index = Entries[i];
+            if (QueryIds[index] != QueryId)
+            {
+                QueryIds[index] = QueryId;
+                out.push_back(index);
+            }
+        }
+    }
+};
+
+/// Returns bounding rect of a bezier curve. Curve is always contained within convex hull of it's control points.
+ImRect GetCurveRect(const ImVec2* p, float thickness)
+{
+    ImRect curve_rect{ImMin(ImMin(p[0], p[1]), ImMin(p[2], p[3])), ImMax(ImMax(p[0], p[1]), ImMax(p[2], p[3]))};
+    curve_rect.Expand(thickness);
+    return curve_rect;
+}
+
+/// Connection curve submitted on current frame, in canvas coordinates.
+struct _CachedCurve
+{
+    void* InputNode = nullptr;
+    ImGuiID InputSlotId = 0;
+    /// Slot title, null when connection was submitted with integer slot ids.
+    const char* InputSlot = nullptr;
+    void* OutputNode = nullptr;
+    ImGuiID OutputSlotId = 0;
+    /// Slot title, null when connection was submitted with integer slot ids.
+    const char* OutputSlot = nullptr;
+    /// Bezier curve control points.
+    ImVec2 P[4]{};
+    /// Curve thickness, unscaled by zoom.
+    float Thickness = 0;
+
+    bool IsSameConnection(void* input_node, ImGuiID input_slot_id, void* output_node, ImGuiID output_slot_id) const
+    {
+        return InputNode == input_node && InputSlotId == input_slot_id && OutputNode == output_node &&
+               OutputSlotId == output_slot_id;
+    }
+};
+
+/// Information about a slot rendered on previous frames.
+struct _SlotRecord
+{
+    /// Record id made by MakeSlotRecordID(). Empty records have id 0.
+    ImGuiID Id;
+    /// Index of slot node in _CanvasStateImpl::Nodes.
+    int NodeIndex;
+    /// Slot connection point relative to node position, unscaled by zoom.
+    ImVec2 Pos;
+    /// Last frame on which slot was rendered.
+    int LastFrame;
+    /// Flag indicating that curve connected to this slot is hovered.
+    bool Hovered;
+};
+
+/// Open addressing hash table of slot records with linear probing.
+struct _SlotTable
+{
+    /// Table of records, size is always zero or a power of two.
+    ImVector<_SlotRecord> Records{};
+    /// Number of non-empty records.
+    int Count = 0;
+
+    _SlotRecord* Find(ImGuiID id)
+    {
+        if (Records.Size == 0)
+            return nullptr;
+
+        ImU32 mask = (ImU32)Records.Size - 1;
+        for (ImU32 i = id & mask;; i = (i + 1) & mask)
+        {
+            _SlotRecord& record = Records.Data[i];
+            if (record.Id == id)
+                return &record;
+            if (record.Id == 0)
+                return nullptr;
+        }
+    }
+
+    /// Returns existing record or inserts a new one. Returned pointer is valid until next call to this function.
+    /// `is_alive` is called for existing records when table grows, records it returns `false` for are dropped.
+    template<typename IsAlive>
+    _SlotRecord* FindOrAdd(ImGuiID id, IsAlive is_alive)
+    {
+        if (_SlotRecord* record = Find(id))
+            return record;
+
+        // Keep load factor under 75%.
+        if ((Count + 1) * 4 > Records.Size * 3)
+            Rehash(ImMax(Records.Size * 2, 64), is_alive);
+
+        _SlotRecord* record = Insert(id);
+        record->NodeIndex = -1;
+        record->Pos = ImVec2{};
+        record->LastFrame = -1;
+        record->Hovered = false;
+        return record;
+    }
+
+    template<typename IsAlive>
+    void Rehash(int capacity, IsAlive is_alive)
+    {
+        ImVector<_SlotRecord> old_records;
+        old_records.swap(Records);
+        Records.resize(capacity);
+        memset((void*)Records.Data, 0, Records.size_in_bytes());
+        Count = 0;
+        for (const _SlotRecord& record : old_records)
+        {
+            if (record.Id != 0 && is_alive(record))
+                *Insert(record.Id) = record;
+        }
+    }
+
+    _SlotRecord* Insert(ImGuiID id)
+    {
+        ImU32 mask = (ImU32)Records.Size - 1;
+        ImU32 i = id & mask;
+        while (Records.Data[i].Id != 0)
+            i = (i + 1) & mask;
+        Count++;
+        Records.Data[i].Id = id;
+        return &Records.Data[i];
+    }
+};
+
+/// Tessellated connection curve remembered from previous frames. Geometry is in screen coordinates.
+struct _CachedEdge
+{
+    /// Curve end points, canvas zoom, curve strength and thickness that geometry was built for.
+    ImVec2 InputPos{};
+    ImVec2 OutputPos{};
+    float Zoom = 0.0f;
+    float Strength = 0.0f;
+    float Thickness = 0.0f;
+    /// Tessellation tolerance and number of segments of simplified curves (0 when not simplified) that geometry was built
+    /// with. Number of curve segments depends on them.
+    float TessTol = 0.0f;
+    int LodSegments = 0;
+    /// Bounding box of the curve, thickness included.
+    ImRect Rect{};
+    /// Tessellated curve.
+    ImVector<ImVec2> Points{};
+    /// Last frame on which entry was rendered.
+    int LastFrame = -1;
+};
+
+/// Visible curve whose rendering is deferred to RenderDeferredCurves(), see CanvasState::DeferredCurves and
+/// Connections().
+struct _DeferredCurve
+{
+    /// Index of curve geometry in _CanvasStateImpl::Edges. Point buffer is already sized for tessellated curve.
+    int EdgeIndex = 0;
+    /// Control points of the curve. Used only when curve has to be tessellated.
+    ImVec2 P[4]{};
+    /// Flag indicating that curve has to be tessellated, otherwise cached points are reused.
+    bool Tessellate = false;
+    ImU32 Color = 0;
+};
+
+/// Connection whose slots were found in slot table.
+struct _ResolvedConnection
+{
+    /// Index of connection in array passed to Connections().
+    int Index;
+    /// Screen positions of connection ends.
+    ImVec2 InputPos;
+    ImVec2 OutputPos;
+    /// Key of curve geometry in _CanvasStateImpl::Edges.
+    ImGuiID EdgeId;
+};
+
+/// Range of deferred curves that is rendered by a single job into its own draw list.
+struct _CurveBatch
+{
+    /// Copy of window draw list shared data, so that jobs do not share any mutable state.
+    ImDrawListSharedData SharedData{};
+    ImDrawList DrawList{&SharedData};
+    /// Range of rendered curves in _CanvasStateImpl::DeferredCurves.
+    int Begin = 0;
+    int End = 0;
+};
+
+/// Range of redraw cache that is emitted into one canvas layer with a single PrimReserve() call.
+struct _RedrawCacheChunk
+{
+    CanvasLayer Layer;
+    int VtxOffset;
+    int VtxCount;
+    int IdxOffset;
+    int IdxCount;
+};
+
+/// Geometry of curve and node layers as of the frame it was captured on. Vertex positions are relative to canvas origin.
+struct _RedrawCache
+{
+    /// Flag indicating that cache may be used.
+    bool Valid = false;
+    /// Canvas and window state on capture.
+    ImVec2 Offset{};
+    float Zoom = 0.0f;
+    ImVec2 WindowPos{};
+    ImVec2 WindowSize{};
+    /// Number of nodes and connections submitted on capture.
+    int NodeCount = 0;
+    int ConnectionCount = 0;
+    /// Texture shared by all captured geometry.
+    ImTextureID TextureId{};
+    ImVector<ImDrawVert> Vtx{};
+    ImVector<ImDrawIdx> Idx{};
+    ImVector<_RedrawCacheChunk> Chunks{};
+    /// Maps window draw list vertex to its copy in `Vtx`. Scratch buffer of capture.
+    ImVector<int> Remap{};
 };
 
 struct _CanvasStateImpl
 {
-    /// Storage for various internal node/slot attributes.
-    ImGuiStorage CachedData{};
+    /// Draw channels of canvas layers.
+    ImDrawListSplitter Layers{};
+    /// Positions and states of rendered slots.
+    _SlotTable Slots{};
+    /// Geometry of nodes rendered on previous frames.
+    _HashPool<_CachedNode> Nodes{};
+    /// Spatial index of nodes in canvas coordinates. Indices refer to `Nodes`. Built at the end of a frame, therefore
+    /// queries return nodes as they were on the previous frame.
+    _SpatialGrid NodeGrid{};
+    /// Connection curves submitted on current frame.
+    ImVector<_CachedCurve> Curves{};
+    /// Spatial index of curves in canvas coordinates. Indices refer to `Curves`.
+    _SpatialGrid CurveGrid{};
+    /// Connection curve nearest to mouse cursor as determined the last frame.
+    _CachedCurve HoveredCurve{};
+    /// Scratch buffer for results of spatial queries.
+    ImVector<int> QueryResult{};
+    /// Scratch buffer for tessellated curve points.
+    ImVector<ImVec2> CurvePoints{};
+    /// Tessellated curves of connections, keyed by a hash of slot record ids of connection ends.
+    _HashPool<_CachedEdge> Edges{};
+    /// Visible curves of current frame, rendered by EndCanvas() when CanvasState::DeferredCurves is enabled. Otherwise
+    /// only holds curves of current Connections() call.
+    ImVector<_DeferredCurve> DeferredCurves{};
+    /// Scratch buffer of connections resolved by Connections().
+    ImVector<_ResolvedConnection> ResolvedConnections{};
+    /// Draw lists of deferred curve rendering jobs. Kept between frames so that their buffers are reused.
+    ImVector<_CurveBatch*> CurveBatches{};
+    /// Number of nodes submitted on current frame.
+    int NodeCount = 0;
+    /// Statistics of current frame.
+    CanvasStats FrameStats{};
+    /// Statistics of last complete frame.
+    CanvasStats Stats{};
+    /// Phase of current frame that is being timed.
+    _CanvasPhase Phase = Phase_BeginCanvas;
+    /// Start time of current phase and of current frame.
+    _StatsClock::time_point PhaseStart{};
+    _StatsClock::time_point FrameStart{};
+    /// Sizes of window draw list buffers at the start of the frame.
+    int FrameVtxStart = 0;
+    int FrameIdxStart = 0;
+    /// Values of allocation counter at the start of the frame.
+    ImU64 FrameAllocStart = 0;
+    ImU64 FrameAllocBytesStart = 0;
+    /// Translation redraw cache, see CanvasState::RedrawCache.
+    _RedrawCache RedrawCache{};
+    /// Flag indicating that current frame is re-emitted from `RedrawCache`.
+    bool RedrawFromCache = false;
+    /// Flag indicating that current frame is rendered with expanded clip rect and captured into `RedrawCache`.
+    bool RedrawCapture = false;
+    /// Window clip rect of current frame, without redraw cache margin.
+    ImVec4 WindowClipRect{};
+    /// Canvas offset on previous frame.
+    ImVec2 PrevOffset{};
     /// Current node data.
     struct
     {
@@ -96,12 +709,27 @@ struct _CanvasStateImpl
         bool* Selected = nullptr;
         /// Stack accumulated ImGui ID for the node item.
         ImGuiID ItemId;
+        /// Screen position of top-left corner of the node.
+        ImVec2 Origin{};
+        /// Node rect. Predicted from previous frame when node is culled.
+        ImRect Rect{};
+        /// Flag indicating that node is outside of visible canvas area and its content is not rendered.
+        bool Culled = false;
+        /// Flag indicating that canvas is zoomed out and node is rendered as a plain rect without content.
+        bool Simplified = false;
+        /// Cached node geometry.
+        _CachedNode* Cache = nullptr;
     } Node;
     /// Current slot data.
     struct
     {
         int Kind = 0;
+        /// User-provided slot id, unique among slots of same direction in current node.
+        ImGuiID Id = 0;
+        /// Slot title, null when slot was created with an integer id.
         const char* Title = nullptr;
+        /// Record of current slot. Valid between BeginSlot() and EndSlot().
+        _SlotRecord* Record = nullptr;
     } slot{};
     /// Node id which will be positioned at the mouse cursor on next frame.
     void* AutoPositionNodeId = nullptr;
@@ -110,10 +738,14 @@ struct _CanvasStateImpl
     {
         /// Node id of input node.
         void* InputNode = nullptr;
+        /// Slot id of input node.
+        ImGuiID InputSlotId = 0;
         /// Slot title of input node.
         const char* InputSlot = nullptr;
         /// Node id of output node.
         void* OutputNode = nullptr;
+        /// Slot id of output node.
+        ImGuiID OutputSlotId = 0;
         /// Slot title of output node.
         const char* OutputSlot = nullptr;
     } NewConnection{};
@@ -133,16 +765,27 @@ struct _CanvasStateImpl
     bool JustConnected = false;
     /// Previous canvas pointer. Used to restore proper gCanvas value when nesting canvases.
     CanvasState* PrevCanvas = nullptr;
-    /// A list of node/slot combos that can not connect to current pending connection.
-    ImVector<_IgnoreSlot> IgnoreConnections{};
+    /// A set of node/slot combos that can not connect to current pending connection.
+    _IgnoreSlotSet IgnoreConnections{};
+    /// Payload type names of pending connections.
+    ImVector<_PayloadType> PayloadTypes{};
+    /// Maps slot kind to index in `PayloadTypes`.
+    ImGuiStorage PayloadTypeIndices{};
+    /// Payload of connection that is being made, null if there is none. Updated once per frame in BeginCanvas() and
+    /// when a new connection is started, so that slots compare kinds instead of payload type names.
+    const _DragConnectionPayload* PendingConnection = nullptr;
     int PrevSelectCount = 0;
     int CurrSelectCount = 0;
     ImGuiID PendingActiveItemId = 0;
     ImGuiID PendingActiveSlotId = 0;
     /// The ID of the currently top-most hovered node as determined the last frame.
     ImGuiID HoveredNodeId = 0;
-    /// The ID of the pending top-most hovered node determined thus far this frame.
-    ImGuiID PendingHoveredNodeId = 0;
+
+    ~_CanvasStateImpl()
+    {
+        for (_CurveBatch* batch : CurveBatches)
+            IM_DELETE(batch);
+    }
 };
 
 CanvasState::CanvasState() noexcept
@@ -166,69 +809,944 @@ CanvasState::~CanvasState()
     delete _Impl;
 }
 
-ImU32 MakeSlotDataID(const char* data, const char* slot_title, void* node_id, bool input_slot)
+/// Converts screen position to canvas coordinates used for node positions.
+ImVec2 ScreenToCanvas(const ImVec2& pos)
+{
+    return (pos - ImGui::GetWindowPos() - gCanvas->Offset) / gCanvas->Zoom;
+}
+
+/// Returns indices of nodes overlapping `rect` in canvas coordinates. Results are stored in a scratch buffer which is
+/// reused by next query.
+const ImVector<int>& QueryNodes(const ImRect& rect)
+{
+    auto* impl = gCanvas->_Impl;
+    impl->QueryResult.resize(0);
+    impl->NodeGrid.Query(rect, impl->QueryResult);
+    for (int i = 0; i < impl->QueryResult.Size;)
+    {
+        if (impl->Nodes.GetByIndex(impl->QueryResult[i])->GetCanvasRect().Overlaps(rect))
+            i++;
+        else
+            impl->QueryResult.erase_unsorted(&impl->QueryResult[i]);
+    }
+    return impl->QueryResult;
+}
+
+/// Returns item id of top-most node under mouse cursor.
+ImGuiID FindHoveredNode()
+{
+    auto* impl = gCanvas->_Impl;
+    if (!ImGui::IsWindowHovered(ImGuiHoveredFlags_AllowWhenBlockedByActiveItem))
+        return 0;
+
+    ImVec2 mouse_pos = ScreenToCanvas(ImGui::GetMousePos());
+    const _CachedNode* hovered = nullptr;
+    for (int node_index : QueryNodes({mouse_pos, mouse_pos}))
+    {
+        const _CachedNode* node = impl->Nodes.GetByIndex(node_index);
+        if (node->GetCanvasRect().Contains(mouse_pos) && (hovered == nullptr || node->Order > hovered->Order))
+            hovered = node;
+    }
+
+    // Similar to ImGui::IsItemHovered(), node is not hovered when some other item is active.
+    ImGuiID active_id = ImGui::GetActiveID();
+    if (hovered == nullptr || (active_id != 0 && active_id != hovered->ItemId))
+        return 0;
+    return hovered->ItemId;
+}
+
+/// Gets screen position of slot connection point. Returns `false` if slot was never rendered. Slot positions are stored
+/// relative to their node, therefore they remain valid when node is culled or canvas is scrolled.
+bool GetSlotScreenPos(ImGuiID slot_id, ImVec2* pos)
+{
+    auto* canvas = gCanvas;
+    auto* impl = canvas->_Impl;
+
+    const _SlotRecord* slot = impl->Slots.Find(slot_id);
+    if (slot == nullptr)
+        return false;
+
+    ImVec2 slot_pos = slot->Pos + impl->Nodes.GetByIndex(slot->NodeIndex)->Pos;
+    *pos = ImGui::GetWindowPos() + slot_pos * canvas->Zoom + canvas->Offset;
+    return true;
+}
+
+/// Updates hovered flag of slot records connected to a hovered curve.
+void SetCurveSlotsHovered(const _CachedCurve& curve, bool hovered)
+{
+    auto* impl = gCanvas->_Impl;
+    if (curve.InputNode == nullptr)
+        return;
+    if (_SlotRecord* slot = impl->Slots.Find(MakeSlotRecordID(curve.InputNode, curve.InputSlotId, true)))
+        slot->Hovered = hovered;
+    if (_SlotRecord* slot = impl->Slots.Find(MakeSlotRecordID(curve.OutputNode, curve.OutputSlotId, false)))
+        slot->Hovered = hovered;
+}
+
+/// Returns drag-drop payload type name of connections starting at slots of specified kind.
+const char* GetPayloadType(int kind)
+{
+    auto* impl = gCanvas->_Impl;
+    int index = impl->PayloadTypeIndices.GetInt((ImGuiID)kind, -1);
+    if (index < 0)
+    {
+        index = impl->PayloadTypes.Size;
+        impl->PayloadTypeIndices.SetInt((ImGuiID)kind, index);
+        impl->PayloadTypes.push_back({kind, {}});
+        snprintf(impl->PayloadTypes[index].Name, sizeof(impl->PayloadTypes[index].Name), "%s%08X",
+            ConnectionPayloadPrefix, kind);
+    }
+    return impl->PayloadTypes[index].Name;
+}
+
+/// Updates payload of connection that is being made.
+void UpdatePendingConnection()
+{
+    auto* impl = gCanvas->_Impl;
+    impl->PendingConnection = nullptr;
+    if (const ImGuiPayload* payload = ImGui::GetDragDropPayload())
+    {
+        if (strncmp(payload->DataType, ConnectionPayloadPrefix, sizeof(ConnectionPayloadPrefix) - 1) == 0)
+            impl->PendingConnection = (const _DragConnectionPayload*)payload->Data;
+    }
+}
+
+/// Attributes time since the start of current phase to that phase and starts timing `phase`.
+void EnterCanvasPhase(_CanvasPhase phase)
+{
+    auto* impl = gCanvas->_Impl;
+    if (impl->Phase == phase)
+        return;
+
+    _StatsClock::time_point now = _StatsClock::now();
+    float elapsed = std::chrono::duration<float, std::milli>(now - impl->PhaseStart).count();
+    CanvasStats& stats = impl->FrameStats;
+    switch (impl->Phase)
+    {
+    case Phase_BeginCanvas: stats.BeginCanvasTime += elapsed; break;
+    case Phase_Nodes:       stats.NodesTime += elapsed; break;
+    case Phase_Connections: stats.ConnectionsTime += elapsed; break;
+    case Phase_EndCanvas:   stats.EndCanvasTime += elapsed; break;
+    }
+    impl->Phase = phase;
+    impl->PhaseStart = now;
+}
+
+/// Returns `true` when canvas is zoomed out enough to render simplified nodes and curves.
+bool IsLodActive()
+{
+    return gCanvas->Zoom < gCanvas->Style.LodZoomThreshold;
+}
+
+/// Returns number of segments needed for polyline to deviate from a cubic bezier curve by no more than `tess_tol`.
+/// Control points and tolerance must be in the same units, curves projected to larger on-screen size get more segments.
+int GetCurveSegmentCount(const ImVec2* p, float tess_tol)
+{
+    if (IsLodActive())
+        return ImMax(gCanvas->Style.LodCurveSegments, 1);
+
+    // Deviation of uniformly tessellated cubic bezier curve is at most 3/4 * max(|p0 - 2p1 + p2|, |p1 - 2p2 + p3|) / n^2.
+    ImVec2 d0 = p[0] - p[1] * 2 + p[2];
+    ImVec2 d1 = p[1] - p[2] * 2 + p[3];
+    float deviation = ImSqrt(ImMax(ImLengthSqr(d0), ImLengthSqr(d1)));
+    int num_segments = (int)ImSqrt(0.75f * deviation / tess_tol) + 1;
+    return ImClamp(num_segments, 1, 64);
+}
+
+// Based on http://paulbourke.net/geometry/pointlineplane/
+float GetDistanceToLineSquared(const ImVec2& point, const ImVec2& a, const ImVec2& b)
+{
+    float tx, ty, t, u;
+    tx = b.x - a.x;
+    ty = b.y - a.y;
+    t = (tx * tx) + (ty * ty);
+    if (t == 0)
+        return ImLengthSqr(point - a);
+    u = ((point.x - a.x) * tx + (point.y - a.y) * ty) / t;
+    if (u > 1)
+        u = 1;
+    else if (u < 0)
+        u = 0;
+    tx = (a.x + u * tx) - point.x;
+    ty = (a.y + u * ty) - point.y;
+    return tx * tx + ty * ty;
+}
+
+/// Evaluates `num_segments + 1` points of cubic bezier curve `p` at uniformly spaced parameters into `out`. Points are
+/// evaluated 8 (AVX2) or 4 (SSE2) at a time when SIMD is available.
+void BezierCubicTessellate(const ImVec2* p, int num_segments, ImVec2* out)
+{
+    IM_ASSERT(num_segments > 0);
+    const int count = num_segments + 1;
+    const float step = 1.0f / num_segments;
+    int i = 0;
+
+#if defined(IMNODES_SIMD_AVX2)
+    {
+        const __m256 p0x = _mm256_set1_ps(p[0].x), p0y = _mm256_set1_ps(p[0].y);
+        const __m256 p1x = _mm256_set1_ps(p[1].x), p1y = _mm256_set1_ps(p[1].y);
+        const __m256 p2x = _mm256_set1_ps(p[2].x), p2y = _mm256_set1_ps(p[2].y);
+        const __m256 p3x = _mm256_set1_ps(p[3].x), p3y = _mm256_set1_ps(p[3].y);
+        const __m256 one = _mm256_set1_ps(1.0f), three = _mm256_set1_ps(3.0f), v_step = _mm256_set1_ps(step);
+        const __m256 lane = _mm256_setr_ps(0, 1, 2, 3, 4, 5, 6, 7);
+        for (; i + 8 <= count; i += 8)
+        {
+            __m256 t = _mm256_mul_ps(_mm256_add_ps(_mm256_set1_ps((float)i), lane), v_step);
+            __m256 u = _mm256_sub_ps(one, t);
+            __m256 tt = _mm256_mul_ps(t, t), uu = _mm256_mul_ps(u, u);
+            __m256 w0 = _mm256_mul_ps(uu, u);
+            __m256 w1 = _mm256_mul_ps(_mm256_mul_ps(three, uu), t);
+            __m256 w2 = _mm256_mul_ps(_mm256_mul_ps(three, u), tt);
+            __m256 w3 = _mm256_mul_ps(tt, t);
+            __m256 x = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(w0, p0x), _mm256_mul_ps(w1, p1x)),
+                                     _mm256_add_ps(_mm256_mul_ps(w2, p2x), _mm256_mul_ps(w3, p3x)));
+            __m256 y = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(w0, p0y), _mm256_mul_ps(w1, p1y)),
+                                     _mm256_add_ps(_mm256_mul_ps(w2, p2y), _mm256_mul_ps(w3, p3y)));
+            // Interleave to x0 y0 x1 y1 ... Unpack works within 128 bit lanes, permute restores point order.
+            __m256 lo = _mm256_unpacklo_ps(x, y), hi = _mm256_unpackhi_ps(x, y);
+            _mm256_storeu_ps(&out[i].x, _mm256_permute2f128_ps(lo, hi, 0x20));
+            _mm256_storeu_ps(&out[i + 4].x, _mm256_permute2f128_ps(lo, hi, 0x31));
+        }
+    }
+#endif
+#if defined(IMNODES_SIMD_SSE2)
+    {
+        const __m128 p0x = _mm_set1_ps(p[0].x), p0y = _mm_set1_ps(p[0].y);
+        const __m128 p1x = _mm_set1_ps(p[1].x), p1y = _mm_set1_ps(p[1].y);
+        const __m128 p2x = _mm_set1_ps(p[2].x), p2y = _mm_set1_ps(p[2].y);
+        const __m128 p3x = _mm_set1_ps(p[3].x), p3y = _mm_set1_ps(p[3].y);
+        const __m128 one = _mm_set1_ps(1.0f), three = _mm_set1_ps(3.0f), v_step = _mm_set1_ps(step);
+        const __m128 lane = _mm_setr_ps(0, 1, 2, 3);
+        for (; i + 4 <= count; i += 4)
+        {
+            __m128 t = _mm_mul_ps(_mm_add_ps(_mm_set1_ps((float)i), lane), v_step);
+            __m128 u = _mm_sub_ps(one, t);
+            __m128 tt = _mm_mul_ps(t, t), uu = _mm_mul_ps(u, u);
+            __m128 w0 = _mm_mul_ps(uu, u);
+            __m128 w1 = _mm_mul_ps(_mm_mul_ps(three, uu), t);
+            __m128 w2 = _mm_mul_ps(_mm_mul_ps(three, u), tt);
+            __m128 w3 = _mm_mul_ps(tt, t);
+            __m128 x = _mm_add_ps(_mm_add_ps(_mm_mul_ps(w0, p0x), _mm_mul_ps(w1, p1x)),
+                                  _mm_add_ps(_mm_mul_ps(w2, p2x), _mm_mul_ps(w3, p3x)));
+            __m128 y = _mm_add_ps(_mm_add_ps(_mm_mul_ps(w0, p0y), _mm_mul_ps(w1, p1y)),
+                                  _mm_add_ps(_mm_mul_ps(w2, p2y), _mm_mul_ps(w3, p3y)));
+            _mm_storeu_ps(&out[i].x, _mm_unpacklo_ps(x, y));
+            _mm_storeu_ps(&out[i + 2].x, _mm_unpackhi_ps(x, y));
+        }
+    }
+#endif
+    for (; i < count; i++)
+    {
+        float t = i * step;
+        float u = 1.0f - t;
+        float w0 = u * u * u;
+        float w1 = 3 * u * u * t;
+        float w2 = 3 * u * t * t;
+        float w3 = t * t * t;
+        out[i] = ImVec2{w0 * p[0].x + w1 * p[1].x + w2 * p[2].x + w3 * p[3].x,
+                        w0 * p[0].y + w1 * p[1].y + w2 * p[2].y + w3 * p[3].y};
+    }
+
+    // Curve ends exactly at slots regardless of rounding.
+    out[0] = p[0];
+    out[num_segments] = p[3];
+}
+
+/// Returns squared distance from `point` to polyline made of `count` points. Distances to 8 (AVX2) or 4 (SSE2) segments
+/// are computed at a time when SIMD is available.
+float PolylineDistanceSqr(const ImVec2* points, int count, const ImVec2& point)
+{
+    IM_ASSERT(count > 0);
+    if (count == 1)
+        return ImLengthSqr(point - points[0]);
+
+    const int num_segments = count - 1;
+    float min_distance = FLT_MAX;
+    int i = 0;
+
+    // Segment distances do not depend on order, therefore SIMD paths deinterleave points in whatever order is cheapest.
+#if defined(IMNODES_SIMD_AVX2)
+    {
+        const __m256 px = _mm256_set1_ps(point.x), py = _mm256_set1_ps(point.y);
+        const __m256 zero = _mm256_setzero_ps(), one = _mm256_set1_ps(1.0f), tiny = _mm256_set1_ps(FLT_MIN);
+        __m256 v_min = _mm256_set1_ps(FLT_MAX);
+        for (; i + 8 <= num_segments; i += 8)
+        {
+            __m256 a0 = _mm256_loadu_ps(&points[i].x), a1 = _mm256_loadu_ps(&points[i + 4].x);
+            __m256 b0 = _mm256_loadu_ps(&points[i + 1].x), b1 = _mm256_loadu_ps(&points[i + 5].x);
+            __m256 ax = _mm256_shuffle_ps(a0, a1, _MM_SHUFFLE(2, 0, 2, 0)), ay = _mm256_shuffle_ps(a0, a1, _MM_SHUFFLE(3, 1, 3, 1));
+            __m256 bx = _mm256_shuffle_ps(b0, b1, _MM_SHUFFLE(2, 0, 2, 0)), by = _mm256_shuffle_ps(b0, b1, _MM_SHUFFLE(3, 1, 3, 1));
+            __m256 dx = _mm256_sub_ps(bx, ax), dy = _mm256_sub_ps(by, ay);
+            __m256 wx = _mm256_sub_ps(px, ax), wy = _mm256_sub_ps(py, ay);
+            __m256 dd = _mm256_add_ps(_mm256_mul_ps(dx, dx), _mm256_mul_ps(dy, dy));
+            __m256 wd = _mm256_add_ps(_mm256_mul_ps(wx, dx), _mm256_mul_ps(wy, dy));
+            __m256 t = _mm256_min_ps(_mm256_max_ps(_mm256_div_ps(wd, _mm256_max_ps(dd, tiny)), zero), one);
+            __m256 ex = _mm256_sub_ps(wx, _mm256_mul_ps(dx, t)), ey = _mm256_sub_ps(wy, _mm256_mul_ps(dy, t));
+            v_min = _mm256_min_ps(v_min, _mm256_add_ps(_mm256_mul_ps(ex, ex), _mm256_mul_ps(ey, ey)));
+        }
+        float lanes[8];
+        _mm256_storeu_ps(lanes, v_min);
+        for (float distance : lanes)
+            min_distance = ImMin(min_distance, distance);
+    }
+#endif
+#if defined(IMNODES_SIMD_SSE2)
+    {
+        const __m128 px = _mm_set1_ps(point.x), py = _mm_set1_ps(point.y);
+        const __m128 zero = _mm_setzero_ps(), one = _mm_set1_ps(1.0f), tiny = _mm_set1_ps(FLT_MIN);
+        __m128 v_min = _mm_set1_ps(FLT_MAX);
+        for (; i + 4 <= num_segments; i += 4)
+        {
+            __m128 a0 = _mm_loadu_ps(&points[i].x), a1 = _mm_loadu_ps(&points[i + 2].x);
+            __m128 b0 = _mm_loadu_ps(&points[i + 1].x), b1 = _mm_loadu_ps(&points[i + 3].x);
+            __m128 ax = _mm_shuffle_ps(a0, a1, _MM_SHUFFLE(2, 0, 2, 0)), ay = _mm_shuffle_ps(a0, a1, _MM_SHUFFLE(3, 1, 3, 1));
+            __m128 bx = _mm_shuffle_ps(b0, b1, _MM_SHUFFLE(2, 0, 2, 0)), by = _mm_shuffle_ps(b0, b1, _MM_SHUFFLE(3, 1, 3, 1));
+            __m128 dx = _mm_sub_ps(bx, ax), dy = _mm_sub_ps(by, ay);
+            __m128 wx = _mm_sub_ps(px, ax), wy = _mm_sub_ps(py, ay);
+            __m128 dd = _mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy));
+            __m128 wd = _mm_add_ps(_mm_mul_ps(wx, dx), _mm_mul_ps(wy, dy));
+            __m128 t = _mm_min_ps(_mm_max_ps(_mm_div_ps(wd, _mm_max_ps(dd, tiny)), zero), one);
+            __m128 ex = _mm_sub_ps(wx, _mm_mul_ps(dx, t)), ey = _mm_sub_ps(wy, _mm_mul_ps(dy, t));
+            v_min = _mm_min_ps(v_min, _mm_add_ps(_mm_mul_ps(ex, ex), _mm_mul_ps(ey, ey)));
+        }
+        float lanes[4];
+        _mm_storeu_ps(lanes, v_min);
+        for (float distance : lanes)
+            min_distance = ImMin(min_distance, distance);
+    }
+#endif
+    for (; i < num_segments; i++)
+        min_distance = ImMin(min_distance, GetDistanceToLineSquared(point, points[i], points[i + 1]));
+
+    return min_distance;
+}
+
+/// Calculates bezier curve control points of a connection.
+void GetConnectionCurve(const ImVec2& input_pos, const ImVec2& output_pos, float curve_strength, ImVec2* p)
+{
+    p[0] = input_pos;
+    p[1] = input_pos - ImVec2{curve_strength, 0};
+    p[2] = output_pos + ImVec2{curve_strength, 0};
+    p[3] = output_pos;
+}
+
+/// Renders connection curve. Returns `false` if curve is not visible. When `edge_id` is not 0 tessellated curve is
+/// cached and reused on later frames for as long as curve shape does not change. When `defer` is set, cached curves are
+/// queued and rendered later by RenderDeferredCurves().
+bool RenderConnection(const ImVec2& input_pos, const ImVec2& output_pos, float thickness, bool hovered, ImGuiID edge_id,
+    bool defer)
+{
+    IMNODES_PROFILE_SCOPE("ImNodes::RenderConnection");
+    ImDrawList* draw_list = ImGui::GetWindowDrawList();
+    CanvasState* canvas = gCanvas;
+    auto* impl = canvas->_Impl;
+    const ImRect& clip_rect = ImGui::GetCurrentWindow()->ClipRect;
+    ImU32 color = hovered ? canvas->Colors[ColConnectionActive] : canvas->Colors[ColConnection];
+    float strength = canvas->Style.CurveStrength;
+    int frame = ImGui::GetCurrentContext()->FrameCount;
+    float tess_tol = ImGui::GetStyle().CurveTessellationTol;
+    int lod_segments = IsLodActive() ? ImMax(canvas->Style.LodCurveSegments, 1) : 0;
+
+    thickness *= canvas->Zoom;
+
+    _CachedEdge* edge = edge_id != 0 ? impl->Edges.GetByKey(edge_id) : nullptr;
+    // Same connection may be submitted more than once. When geometry of the entry is already queued for rendering on
+    // current frame, it may be tessellated by one job while being read by another, therefore duplicate is rendered
+    // immediately from scratch buffer.
+    bool queued = edge != nullptr && edge->LastFrame == frame && defer;
+    if (edge != nullptr && !queued && edge->Zoom == canvas->Zoom && edge->Strength == strength &&
+        edge->Thickness == thickness && edge->TessTol == tess_tol && edge->LodSegments == lod_segments)
+    {
+        ImVec2 input_delta = input_pos - edge->InputPos;
+        ImVec2 output_delta = output_pos - edge->OutputPos;
+        if (ImFabs(input_delta.x - output_delta.x) < 0.01f && ImFabs(input_delta.y - output_delta.y) < 0.01f)
+        {
+            // Curve shape did not change. Both ends move by the same distance when canvas is panned.
+            if (input_delta.x != 0 || input_delta.y != 0)
+            {
+                for (ImVec2& point : edge->Points)
+                    point += input_delta;
+                edge->Rect.Translate(input_delta);
+                edge->InputPos += input_delta;
+                edge->OutputPos += input_delta;
+            }
+            edge->LastFrame = frame;
+
+            // Curve is not visible.
+            if (!edge->Rect.Overlaps(clip_rect))
+                return false;
+
+            if (defer)
+            {
+                _DeferredCurve curve{};
+                curve.EdgeIndex = impl->Edges.GetIndex(edge);
+                curve.Color = color;
+                impl->DeferredCurves.push_back(curve);
+                return true;
+            }
+            draw_list->AddPolyline(edge->Points.Data, edge->Points.Size, color, 0, thickness);
+            return true;
+        }
+    }
+
+    ImVec2 p[4];
+    GetConnectionCurve(input_pos, output_pos, strength * canvas->Zoom, p);
+    ImRect rect = GetCurveRect(p, thickness);
+
+    // Curve is not visible.
+    if (!rect.Overlaps(clip_rect))
+        return false;
+
+    if (edge_id != 0 && edge == nullptr)
+        edge = impl->Edges.GetOrAddByKey(edge_id);
+    else if (queued)
+        edge = nullptr;
+    if (edge != nullptr)
+    {
+        edge->InputPos = input_pos;
+        edge->OutputPos = output_pos;
+        edge->Zoom = canvas->Zoom;
+        edge->Strength = strength;
+        edge->Thickness = thickness;
+        edge->TessTol = tess_tol;
+        edge->LodSegments = lod_segments;
+        edge->Rect = rect;
+        edge->LastFrame = frame;
+    }
+
+    int num_segments = GetCurveSegmentCount(p, tess_tol);
+    ImVector<ImVec2>& points = edge != nullptr ? edge->Points : impl->CurvePoints;
+    points.resize(num_segments + 1);
+    impl->FrameStats.CurvesTessellated++;
+    if (edge != nullptr && defer)
+    {
+        _DeferredCurve curve{};
+        curve.EdgeIndex = impl->Edges.GetIndex(edge);
+        memcpy(curve.P, p, sizeof(p));
+        curve.Tessellate = true;
+        curve.Color = color;
+        impl->DeferredCurves.push_back(curve);
+        return true;
+    }
+    BezierCubicTessellate(p, num_segments, points.Data);
+    draw_list->AddPolyline(points.Data, points.Size, color, 0, thickness);
+    return true;
+}
+
+/// Drops cached curves of connections that were not rendered on current frame. Cache is trimmed only when most of its
+/// entries are stale, so that cost of the sweep is amortized.
+void TrimEdgeCache()
+{
+    auto* impl = gCanvas->_Impl;
+    if (impl->Edges.GetAliveCount() <= impl->FrameStats.ConnectionsDrawn * 2 + 64)
+        return;
+
+    int frame = ImGui::GetCurrentContext()->FrameCount;
+    for (int i = 0; i < impl->Edges.GetSize(); i++)
+    {
+        _CachedEdge* edge = impl->Edges.TryGetByIndex(i);
+        if (edge != nullptr && edge->LastFrame != frame)
+            impl->Edges.Remove(edge);
+    }
+}
+
+/// Drops cached nodes that were not submitted for a few frames, along with records of their slots. Like edge cache,
+/// node cache is trimmed only when most of its entries are stale.
+void TrimNodeCache()
+{
+    auto* impl = gCanvas->_Impl;
+    if (impl->Nodes.GetAliveCount() <= impl->NodeCount * 2 + 64)
+        return;
+
+    // Nodes which are briefly not submitted (for example when their window is collapsed) keep their state.
+    int oldest_frame = ImGui::GetCurrentContext()->FrameCount - 3;
+    auto is_stale = [impl, oldest_frame](int node_index) {
+        return impl->Nodes.GetByIndex(node_index)->LastFrame < oldest_frame;
+    };
+
+    // Slot records refer to nodes by index, indices of removed nodes are reused.
+    if (impl->Slots.Records.Size > 0)
+    {
+        impl->Slots.Rehash(impl->Slots.Records.Size, [&is_stale](const _SlotRecord& record) {
+            return !is_stale(record.NodeIndex);
+        });
+    }
+    for (int i = 0; i < impl->Nodes.GetSize(); i++)
+    {
+        if (_CachedNode* node = impl->Nodes.TryGetByIndex(i))
+        {
+            if (is_stale(i))
+                impl->Nodes.Remove(node);
+        }
+    }
+}
+
+/// Returns connection curve nearest to mouse cursor. Only curves submitted on current frame are considered.
+_CachedCurve FindHoveredCurve()
+{
+    IMNODES_PROFILE_SCOPE("ImNodes::FindHoveredCurve");
+    auto* canvas = gCanvas;
+    auto* impl = canvas->_Impl;
+    if (!ImGui::IsWindowHovered(ImGuiHoveredFlags_AllowWhenBlockedByActiveItem))
+        return {};
+
+    ImVec2 mouse_pos = ScreenToCanvas(ImGui::GetMousePos());
+    float tess_tol = ImGui::GetStyle().CurveTessellationTol / canvas->Zoom;
+    const _CachedCurve* hovered = nullptr;
+    float hovered_distance = FLT_MAX;
+
+    impl->QueryResult.resize(0);
+    impl->CurveGrid.Query({mouse_pos, mouse_pos}, impl->QueryResult);
+    for (int curve_index : impl->QueryResult)
+    {
+        const _CachedCurve& curve = impl->Curves[curve_index];
+        // Mouse is too far away for curve to be hovered.
+        if (!GetCurveRect(curve.P, curve.Thickness).Contains(mouse_pos))
+            continue;
+        impl->FrameStats.CurveHitTests++;
+        // Curve is hovered when mouse is within its thickness, therefore error of half the thickness is not noticeable
+        // and hover test may use fewer segments than rendering.
+        int num_segments = GetCurveSegmentCount(curve.P, ImMax(tess_tol, curve.Thickness * 0.5f));
+        ImVector<ImVec2>& points = impl->CurvePoints;
+        points.resize(num_segments + 1);
+        BezierCubicTessellate(curve.P, num_segments, points.Data);
+        float square_distance = PolylineDistanceSqr(points.Data, points.Size, mouse_pos);
+        if (square_distance <= curve.Thickness * curve.Thickness && square_distance < hovered_distance)
+        {
+            hovered = &curve;
+            hovered_distance = square_distance;
+        }
+    }
+
+    return hovered ? *hovered : _CachedCurve{};
+}
+
+#ifndef IMNODES_NO_THREADS
+/// Built-in job scheduler used when CanvasState::ParallelFor is not set. Worker threads are started on first use and
+/// sleep while there is no work. Calling thread executes jobs as well.
+struct _ThreadPool
+{
+    std::vector<std::thread> Workers;
+    /// Held for the duration of ParallelFor() call.
+    std::mutex CallMutex;
+    /// Protects state shared with workers.
+    std::mutex Mutex;
+    std::condition_variable WorkReady;
+    std::condition_variable WorkDone;
+    /// Incremented for every ParallelFor() call, wakes up workers.
+    unsigned Generation = 0;
+    /// Number of workers that did not finish current generation yet.
+    int Busy = 0;
+    bool Quit = false;
+    /// Current work. Written under lock before workers are woken up.
+    JobFunc Job = nullptr;
+    void* JobData = nullptr;
+    int JobCount = 0;
+    std::atomic<int> NextJob{0};
+
+    ~_ThreadPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(Mutex);
+            Quit = true;
+        }
+        WorkReady.notify_all();
+        for (std::thread& worker : Workers)
+            worker.join();
+    }
+
+    void ParallelFor(int job_count, JobFunc job, void* job_data)
+    {
+        // Pool is shared by all canvases and ImGui contexts, calls made from different threads are executed one at a time.
+        std::lock_guard<std::mutex> call_lock(CallMutex);
+        if (Workers.empty())
+        {
+            int worker_count = (int)std::thread::hardware_concurrency() - 1;
+            for (int i = 0; i < worker_count; i++)
+                Workers.emplace_back([this]() { WorkerMain(); });
+        }
+
+        if (Workers.empty() || job_count < 2)
+        {
+            for (int i = 0; i < job_count; i++)
+                job(job_data, i);
+            return;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(Mutex);
+            Job = job;
+            JobData = job_data;
+            JobCount = job_count;
+            NextJob = 0;
+            Busy = (int)Workers.size();
+            Generation++;
+        }
+        WorkReady.notify_all();
+        RunJobs();
+
+        std::unique_lock<std::mutex> lock(Mutex);
+        WorkDone.wait(lock, [this]() { return Busy == 0; });
+    }
+
+    void RunJobs()
+    {
+        for (int i = NextJob++; i < JobCount; i = NextJob++)
+            Job(JobData, i);
+    }
+
+    void WorkerMain()
+    {
+        unsigned generation = 0;
+        for (;;)
+        {
+            {
+                std::unique_lock<std::mutex> lock(Mutex);
+                WorkReady.wait(lock, [&]() { return Quit || Generation != generation; });
+                if (Quit)
+                    return;
+                generation = Generation;
+            }
+            RunJobs();
+            {
+                std::lock_guard<std::mutex> lock(Mutex);
+                if (--Busy == 0)
+                    WorkDone.notify_one();
+            }
+        }
+    }
+};
+
+static _ThreadPool gThreadPool;
+#endif
+
+/// Renders a batch of deferred curves into draw list of the batch. Executed by job scheduler, must not touch any state
+/// other than its own batch.
+void RenderCurveBatch(void* job_data, int job_index)
+{
+    auto* impl = (_CanvasStateImpl*)job_data;
+    _CurveBatch* batch = impl->CurveBatches[job_index];
+    for (int i = batch->Begin; i < batch->End; i++)
+    {
+        const _DeferredCurve& curve = impl->DeferredCurves[i];
+        _CachedEdge* edge = impl->Edges.GetByIndex(curve.EdgeIndex);
+        if (curve.Tessellate)
+            BezierCubicTessellate(curve.P, edge->Points.Size - 1, edge->Points.Data);
+        batch->DrawList.AddPolyline(edge->Points.Data, edge->Points.Size, curve.Color, 0, edge->Thickness);
+    }
+}
+
+/// Renders queued curves, which are recorded by Connection() when CanvasState::DeferredCurves is enabled and by
+/// Connections(). Curves are split into batches which are rendered into draw lists of their own, by parallel jobs when
+/// `parallel` is set. Draw list buffers are reserved upfront, so jobs do not allocate memory. Batches are then appended
+/// to current draw channel in order of submission, each with a single PrimReserve() call.
+void RenderDeferredCurves(ImDrawList* draw_list, bool parallel)
+{
+    IMNODES_PROFILE_SCOPE("ImNodes::RenderDeferredCurves");
+    auto* canvas = gCanvas;
+    auto* impl = canvas->_Impl;
+    if (impl->DeferredCurves.empty())
+        return;
+
+    // Thick anti-aliased polyline needs the most geometry: 4 vertices per point and 18 indices per segment.
+    int total_vtx = 0;
+    for (const _DeferredCurve& curve : impl->DeferredCurves)
+        total_vtx += impl->Edges.GetByIndex(curve.EdgeIndex)->Points.Size * 4;
+    // Enough batches for balancing load, but batches must stay small enough for 16-bit indices.
+    const int vtx_budget = ImClamp(total_vtx / 32, 4096, 60000);
+
+    int batch_count = 0;
+    for (int i = 0; i < impl->DeferredCurves.Size;)
+    {
+        if (batch_count == impl->CurveBatches.Size)
+            impl->CurveBatches.push_back(IM_NEW(_CurveBatch)());
+        _CurveBatch* batch = impl->CurveBatches[batch_count++];
+        int vtx_count = 0, idx_count = 0;
+        batch->Begin = i;
+        for (; i < impl->DeferredCurves.Size; i++)
+        {
+            int points_count = impl->Edges.GetByIndex(impl->DeferredCurves[i].EdgeIndex)->Points.Size;
+            if (i > batch->Begin && vtx_count + points_count * 4 > vtx_budget)
+                break;
+            vtx_count += points_count * 4;
+            idx_count += (points_count - 1) * 18;
+        }
+        batch->End = i;
+
+        batch->SharedData = *draw_list->_Data;
+        batch->DrawList._ResetForNewFrame();
+        batch->DrawList.Flags = draw_list->Flags;
+        batch->DrawList._FringeScale = draw_list->_FringeScale;
+        batch->DrawList.VtxBuffer.reserve(vtx_count);
+        batch->DrawList.IdxBuffer.reserve(idx_count);
+    }
+
+    if (batch_count == 1 || !parallel)
+    {
+        for (int i = 0; i < batch_count; i++)
+            RenderCurveBatch(impl, i);
+    }
+    else if (canvas->ParallelFor != nullptr)
+        canvas->ParallelFor(canvas->ParallelForUserData, batch_count, &RenderCurveBatch, impl);
+    else
+    {
+#ifndef IMNODES_NO_THREADS
+        gThreadPool.ParallelFor(batch_count, &RenderCurveBatch, impl);
+#else
+        for (int i = 0; i < batch_count; i++)
+            RenderCurveBatch(impl, i);
+#endif
+    }
+
+    // Append batches to current draw channel, rebasing their indices.
+    for (int i = 0; i < batch_count; i++)
+    {
+        const ImDrawList& batch_list = impl->CurveBatches[i]->DrawList;
+        IM_ASSERT(batch_list.CmdBuffer.Size == 1);
+        if (batch_list.IdxBuffer.empty())
+            continue;
+
+        draw_list->PrimReserve(batch_list.IdxBuffer.Size, batch_list.VtxBuffer.Size);
+        memcpy(draw_list->_VtxWritePtr, batch_list.VtxBuffer.Data, batch_list.VtxBuffer.size_in_bytes());
+        unsigned int base_idx = draw_list->_VtxCurrentIdx;
+        for (int j = 0; j < batch_list.IdxBuffer.Size; j++)
+            draw_list->_IdxWritePtr[j] = (ImDrawIdx)(batch_list.IdxBuffer.Data[j] + base_idx);
+        draw_list->_VtxWritePtr += batch_list.VtxBuffer.Size;
+        draw_list->_IdxWritePtr += batch_list.IdxBuffer.Size;
+        draw_list->_VtxCurrentIdx += batch_list.VtxBuffer.Size;
+    }
+    impl->DeferredCurves.resize(0);
+}
+
+/// Renders canvas grid. Grid levels denser than `CanvasState::Style.GridMinSpacing` are skipped, minor lines of the
+/// finest rendered level fade out as they approach that spacing. Lines are axis-aligned, so they are emitted as a single
+/// batch of one pixel wide rects instead of anti-aliased lines.
+void RenderGrid(ImDrawList* draw_list, const ImVec2& pos, const ImVec2& size)
+{
+    IMNODES_PROFILE_SCOPE("ImNodes::RenderGrid");
+    CanvasState* canvas = gCanvas;
+    int major_interval = canvas->Style.GridMajorInterval;
+    float min_spacing = ImMax(canvas->Style.GridMinSpacing, 1.0f);
+    float spacing = canvas->Style.GridSpacing * canvas->Zoom;
+    if (spacing <= 0)
+        return;
+
+    if (major_interval > 1)
+    {
+        while (spacing <= min_spacing)
+            spacing *= major_interval;
+    }
+
+    ImColor major_color = canvas->Colors[ColCanvasLines];
+    ImColor minor_color = major_color;
+    minor_color.Value.w *= ImSaturate(spacing / min_spacing - 1.0f);
+    if (major_interval < 2 && minor_color.Value.w <= 0)
+        return;
+
+    // Index of first visible line on each axis, counted from canvas origin.
+    int first_x = (int)ceilf(-canvas->Offset.x / spacing);
+    int first_y = (int)ceilf(-canvas->Offset.y / spacing);
+    float start_x = canvas->Offset.x + first_x * spacing;
+    float start_y = canvas->Offset.y + first_y * spacing;
+    int count_x = start_x < size.x ? (int)((size.x - start_x) / spacing) + 1 : 0;
+    int count_y = start_y < size.y ? (int)((size.y - start_y) / spacing) + 1 : 0;
+    if (count_x + count_y <= 0)
+        return;
+
+    auto is_major = [major_interval](int index) {
+        return major_interval > 1 && index % major_interval == 0;
+    };
+
+    draw_list->PrimReserve((count_x + count_y) * 6, (count_x + count_y) * 4);
+    for (int i = 0; i < count_x; i++)
+    {
+        float x = ImFloor(pos.x + start_x + i * spacing);
+        ImU32 color = is_major(first_x + i) ? major_color : minor_color;
+        draw_list->PrimRect(ImVec2{x, pos.y}, ImVec2{x + 1, pos.y + size.y}, color);
+    }
+    for (int i = 0; i < count_y; i++)
+    {
+        float y = ImFloor(pos.y + start_y + i * spacing);
+        ImU32 color = is_major(first_y + i) ? major_color : minor_color;
+        draw_list->PrimRect(ImVec2{pos.x, y}, ImVec2{pos.x + size.x, y + 1}, color);
+    }
+}
+
+/// Decides whether current frame is re-emitted from redraw cache or rendered and captured into it. Captured frame is
+/// rendered with window clip rect expanded by `CanvasState::Style.RedrawCacheMargin`, so that nodes and curves near the
+/// window are not culled.
+void UpdateRedrawCache()
+{
+    auto* canvas = gCanvas;
+    auto* impl = canvas->_Impl;
+    _RedrawCache& cache = impl->RedrawCache;
+    ImGuiWindow* window = ImGui::GetCurrentWindow();
+    bool panned = canvas->Offset.x != impl->PrevOffset.x || canvas->Offset.y != impl->PrevOffset.y;
+    impl->PrevOffset = canvas->Offset;
+    impl->WindowClipRect = window->ClipRect.ToVec4();
+    impl->RedrawFromCache = false;
+    impl->RedrawCapture = false;
+    if (!canvas->RedrawCache)
+    {
+        cache.Valid = false;
+        return;
+    }
+
+    // Cache is used only while canvas is panned and nothing else is interacted with, because node content may change on
+    // any other frame.
+    ImVec2 delta = canvas->Offset - cache.Offset;
+    float margin = canvas->Style.RedrawCacheMargin;
+    impl->RedrawFromCache = cache.Valid && panned && canvas->Zoom == cache.Zoom &&
+        ImFabs(delta.x) <= margin && ImFabs(delta.y) <= margin &&
+        window->Pos.x == cache.WindowPos.x && window->Pos.y == cache.WindowPos.y &&
+        window->Size.x == cache.WindowSize.x && window->Size.y == cache.WindowSize.y &&
+        impl->State == State_None && impl->PendingConnection == nullptr && impl->AutoPositionNodeId == nullptr &&
+        impl->DoSelectionsFrame < ImGui::GetCurrentContext()->FrameCount &&
+        !ImGui::IsMouseDown(0) && !ImGui::IsMouseReleased(0);
+    if (impl->RedrawFromCache)
+        return;
+
+    impl->RedrawCapture = true;
+    ImRect clip_rect = window->ClipRect;
+    clip_rect.Expand(margin);
+    ImGui::PushClipRect(clip_rect.Min, clip_rect.Max, false);
+}
+
+/// Copies geometry of curve and node layers into redraw cache. Restores window clip rect that was expanded by
+/// UpdateRedrawCache() and clips geometry rendered with expanded clip rect to the window. Must be called before canvas
+/// layers are merged.
+void CaptureRedrawCache(ImDrawList* draw_list)
+{
+    auto* canvas = gCanvas;
+    auto* impl = canvas->_Impl;
+    _RedrawCache& cache = impl->RedrawCache;
+    ImVec4 expanded_clip_rect = draw_list->_ClipRectStack.back();
+    ImGui::PopClipRect();
+
+    ImVec2 origin = ImGui::GetWindowPos() + canvas->Offset;
+    cache.Valid = true;
+    cache.Offset = canvas->Offset;
+    cache.Zoom = canvas->Zoom;
+    cache.WindowPos = ImGui::GetWindowPos();
+    cache.WindowSize = ImGui::GetWindowSize();
+    cache.NodeCount = impl->NodeCount;
+    cache.ConnectionCount = impl->FrameStats.ConnectionsSubmitted;
+    cache.TextureId = ImTextureID{};
+    cache.Vtx.resize(0);
+    cache.Idx.resize(0);
+    cache.Chunks.resize(0);
+    cache.Remap.resize(draw_list->VtxBuffer.Size - impl->FrameVtxStart);
+    memset((void*)cache.Remap.Data, 0xFF, cache.Remap.size_in_bytes());    // -1
+
+    bool has_texture = false;
+    for (int layer = 0; layer < LayerMax; layer++)
+    {
+        SetCanvasLayer((CanvasLayer)layer);
+        bool is_cached_layer = layer >= LayerCurves && layer <= LayerNodeContent;
+        int chunk_vtx = cache.Vtx.Size;
+        int chunk_idx = cache.Idx.Size;
+        for (ImDrawCmd& cmd : draw_list->CmdBuffer)
+        {
+            bool is_expanded = memcmp(&cmd.ClipRect, &expanded_clip_rect, sizeof(ImVec4)) == 0;
+            if (is_expanded)
+                cmd.ClipRect = impl->WindowClipRect;
+            if (!is_cached_layer || cmd.ElemCount == 0 || !cache.Valid)
+                continue;
+
+            if (cmd.UserCallback != nullptr || !is_expanded || (has_texture && cmd.TextureId != cache.TextureId))
+            {
+                // Custom clipping, textures and callbacks are not cached.
+                cache.Valid = false;
+                continue;
+            }
+            cache.TextureId = cmd.TextureId;
+            has_texture = true;
+
+            for (unsigned int i = 0; i < cmd.ElemCount; i += 3)
+            {
+                // Chunk is emitted with a single PrimReserve() call and must be addressable by 16-bit indices.
+                if (sizeof(ImDrawIdx) == 2 && cache.Vtx.Size - chunk_vtx + 3 > 0xFFFF)
+                {
+                    cache.Chunks.push_back({(CanvasLayer)layer, chunk_vtx, cache.Vtx.Size - chunk_vtx, chunk_idx, cache.Idx.Size - chunk_idx});
+                    chunk_vtx = cache.Vtx.Size;
+                    chunk_idx = cache.Idx.Size;
+                }
+                for (unsigned int k = 0; k < 3; k++)
+                {
+                    int vtx_index = (int)(cmd.VtxOffset + draw_list->IdxBuffer.Data[cmd.IdxOffset + i + k]);
+                    IM_ASSERT(vtx_index >= impl->FrameVtxStart);
+                    int& cached_index = cache.Remap.Data[vtx_index - impl->FrameVtxStart];
+                    if (cached_index < chunk_vtx)
+                    {
+                        // Vertex was not copied yet or it belongs to previous chunk.
+                        cached_index = cache.Vtx.Size;
+                        ImDrawVert vtx = draw_list->VtxBuffer.Data[vtx_index];
+                        vtx.pos -= origin;
+                        cache.Vtx.push_back(vtx);
+                    }
+                    cache.Idx.push_back((ImDrawIdx)(cached_index - chunk_vtx));
+                }
+            }
+        }
+        if (is_cached_layer && cache.Idx.Size > chunk_idx)
+            cache.Chunks.push_back({(CanvasLayer)layer, chunk_vtx, cache.Vtx.Size - chunk_vtx, chunk_idx, cache.Idx.Size - chunk_idx});
+    }
+}
+
+/// Emits geometry of redraw cache translated to current canvas offset.
+void EmitRedrawCache(ImDrawList* draw_list)
 {
-    ImU32 slot_id = ImHashStr(slot_title, 0, ImHashData(&node_id, sizeof(node_id)));
-    if (input_slot)
+    auto* canvas = gCanvas;
+    auto* impl = canvas->_Impl;
+    _RedrawCache& cache = impl->RedrawCache;
+    ImVec2 origin = ImGui::GetWindowPos() + canvas->Offset;
+    for (const _RedrawCacheChunk& chunk : cache.Chunks)
     {
-        // Ensure that input and output slots with same name have different ids.
-        slot_id ^= ~0U;
+        SetCanvasLayer(chunk.Layer);
+        draw_list->PushTextureID(cache.TextureId);
+        draw_list->PrimReserve(chunk.IdxCount, chunk.VtxCount);
+        const ImDrawVert* src_vtx = cache.Vtx.Data + chunk.VtxOffset;
+        for (int i = 0; i < chunk.VtxCount; i++)
+        {
+            draw_list->_VtxWritePtr[i] = src_vtx[i];
+            draw_list->_VtxWritePtr[i].pos += origin;
+        }
+        const ImDrawIdx* src_idx = cache.Idx.Data + chunk.IdxOffset;
+        unsigned int base_idx = draw_list->_VtxCurrentIdx;
+        for (int i = 0; i < chunk.IdxCount; i++)
+            draw_list->_IdxWritePtr[i] = (ImDrawIdx)(base_idx + src_idx[i]);
+        draw_list->_VtxWritePtr += chunk.VtxCount;
+        draw_list->_IdxWritePtr += chunk.IdxCount;
+        draw_list->_VtxCurrentIdx += chunk.VtxCount;
+        draw_list->PopTextureID();
     }
-    return ImHashStr(data, 0, slot_id);
-}
-
-// Based on http://paulbourke.net/geometry/pointlineplane/
-float GetDistanceToLineSquared(const ImVec2& point, const ImVec2& a, const ImVec2& b)
-{
-    float tx, ty, t, u;
-    tx = b.x - a.x;
-    ty = b.y - a.y;
-    t = (tx * tx) + (ty * ty);
-    u = ((point.x - a.x) * tx + (point.y - a.y) * ty) / t;
-    if (u > 1)
-        u = 1;
-    else if (u < 0)
-        u = 0;
-    tx = (a.x + u * tx) - point.x;
-    ty = (a.y + u * ty) - point.y;
-    return tx * tx + ty * ty;
-}
-
-bool RenderConnection(const ImVec2& input_pos, const ImVec2& output_pos, float thickness)
-{
-    ImDrawList* draw_list = ImGui::GetWindowDrawList();
-    CanvasState* canvas = gCanvas;
-    const ImGuiStyle& style = ImGui::GetStyle();
-
-    thickness *= canvas->Zoom;
+    impl->FrameStats.FromRedrawCache = true;
 
-    ImVec2 p2 = input_pos - ImVec2{canvas->Style.CurveStrength * canvas->Zoom, 0};
-    ImVec2 p3 = output_pos + ImVec2{canvas->Style.CurveStrength * canvas->Zoom, 0};
-#if IMGUI_VERSION_NUM < 18000
-    ImVec2 closest_pt = ImBezierClosestPointCasteljau(input_pos, p2, p3, output_pos, ImGui::GetMousePos(), style.CurveTessellationTol);
-#else
-    ImVec2 closest_pt = ImBezierCubicClosestPointCasteljau(input_pos, p2, p3, output_pos, ImGui::GetMousePos(), style.CurveTessellationTol);
-#endif
-    float min_square_distance = ImFabs(ImLengthSqr(ImGui::GetMousePos() - closest_pt));
-    bool is_close = min_square_distance <= thickness * thickness;
-#if IMGUI_VERSION_NUM < 18000
-    draw_list->AddBezierCurve(input_pos, p2, p3, output_pos, is_close ? canvas->Colors[ColConnectionActive] : canvas->Colors[ColConnection], thickness, 0);
-#else
-    draw_list->AddBezierCubic(input_pos, p2, p3, output_pos, is_close ? canvas->Colors[ColConnectionActive] : canvas->Colors[ColConnection], thickness, 0);
-#endif
-    return is_close;
+    // Nodes or connections were added or removed, render canvas again on the next frame.
+    if (impl->NodeCount != cache.NodeCount || impl->FrameStats.ConnectionsSubmitted != cache.ConnectionCount)
+        cache.Valid = false;
 }
 
 void BeginCanvas(CanvasState* canvas)
 {
+    IMNODES_PROFILE_SCOPE("ImNodes::BeginCanvas");
     canvas->_Impl->PrevCanvas = gCanvas;
     gCanvas = canvas;
     const ImGuiWindow* w = ImGui::GetCurrentWindow();
     ImGui::PushID(canvas);
 
     ImGui::ItemAdd(w->ContentRegionRect, ImGui::GetID("canvas"));
+    UpdatePendingConnection();
 
     ImDrawList* draw_list = ImGui::GetWindowDrawList();
+    canvas->_Impl->FrameStats = CanvasStats{};
+    canvas->_Impl->Phase = Phase_BeginCanvas;
+    canvas->_Impl->FrameStart = canvas->_Impl->PhaseStart = _StatsClock::now();
+    canvas->_Impl->FrameVtxStart = draw_list->VtxBuffer.Size;
+    canvas->_Impl->FrameIdxStart = draw_list->IdxBuffer.Size;
+    canvas->_Impl->FrameAllocStart = gAllocationCounter.Count;
+    canvas->_Impl->FrameAllocBytesStart = gAllocationCounter.Bytes;
+
     ImGuiIO& io = ImGui::GetIO();
 
     if (!ImGui::IsMouseDown(0) && ImGui::IsWindowHovered())
@@ -258,70 +1776,88 @@ void BeginCanvas(CanvasState* canvas)
         }
     }
 
-    const float grid = canvas->Style.GridSpacing * canvas->Zoom;
+    // Offset and zoom are final, decide whether redraw cache is used.
+    UpdateRedrawCache();
+    canvas->_Impl->Layers.Split(draw_list, LayerMax);
+    SetCanvasLayer(LayerGrid);
 
-    ImVec2 pos = ImGui::GetWindowPos();
-    ImVec2 size = ImGui::GetWindowSize();
+    RenderGrid(draw_list, ImGui::GetWindowPos(), ImGui::GetWindowSize());
+    SetCanvasLayer(LayerNodeContent);
 
-    ImU32 grid_color = ImColor(canvas->Colors[ColCanvasLines]);
-    for (float x = fmodf(canvas->Offset.x, grid); x < size.x;)
-    {
-        draw_list->AddLine(ImVec2(x, 0) + pos, ImVec2(x, size.y) + pos, grid_color);
-        x += grid;
-    }
+    ImGui::SetWindowFontScale(canvas->Zoom);
+
+    auto* impl = canvas->_Impl;
+    impl->PrevSelectCount = impl->CurrSelectCount;
+    impl->CurrSelectCount = 0;
+    impl->NodeCount = 0;
 
-    for (float y = fmodf(canvas->Offset.y, grid); y < size.y;)
+    if (impl->State == State_Select)
     {
-        draw_list->AddLine(ImVec2(0, y) + pos, ImVec2(size.x, y) + pos, grid_color);
-        y += grid;
+        // Mark nodes contained in selection rect. EndNode() will update their selection status.
+        ImRect selection_rect{ScreenToCanvas(ImMin(impl->SelectionStart, ImGui::GetMousePos())),
+                              ScreenToCanvas(ImMax(impl->SelectionStart, ImGui::GetMousePos()))};
+        for (int node_index : QueryNodes(selection_rect))
+        {
+            _CachedNode* node = impl->Nodes.GetByIndex(node_index);
+            if (selection_rect.Contains(node->GetCanvasRect()))
+                node->SelectionFrame = ImGui::GetCurrentContext()->FrameCount;
+        }
     }
 
-    ImGui::SetWindowFontScale(canvas->Zoom);
-
-    canvas->_Impl->PrevSelectCount = canvas->_Impl->CurrSelectCount;
-    canvas->_Impl->CurrSelectCount = 0;
+    impl->NodeGrid.Clear();
+    impl->CurveGrid.Clear();
+    impl->Curves.resize(0);
 }
 
 void EndCanvas()
 {
+    IMNODES_PROFILE_SCOPE("ImNodes::EndCanvas");
     IM_ASSERT(gCanvas != nullptr);     // Did you forget calling BeginCanvas()?
 
     ImDrawList* draw_list = ImGui::GetWindowDrawList();
     auto* canvas = gCanvas;
     auto* impl = canvas->_Impl;
+    EnterCanvasPhase(Phase_EndCanvas);
+
+    CanvasLayer prev_layer = SetCanvasLayer(LayerCurves);
+    RenderDeferredCurves(draw_list, true);
+    SetCanvasLayer(prev_layer);
+
+    impl->NodeGrid.Build();
+    impl->CurveGrid.Build();
+    TrimEdgeCache();
+    TrimNodeCache();
+    SetCurveSlotsHovered(impl->HoveredCurve, false);
+    impl->HoveredCurve = FindHoveredCurve();
+    SetCurveSlotsHovered(impl->HoveredCurve, true);
+
+    SetCanvasLayer(LayerOverlay);
 
     // Draw pending connection
-    if (const ImGuiPayload* payload = ImGui::GetDragDropPayload())
+    if (const _DragConnectionPayload* drag_data = impl->PendingConnection)
     {
-        char data_type_fragment[] = "new-node-connection-";
-        if (strncmp(payload->DataType, data_type_fragment, sizeof(data_type_fragment) - 1) == 0)
-        {
-            auto* drag_data = (_DragConnectionPayload*)payload->Data;
-            ImVec2 slot_pos{
-                impl->CachedData.GetFloat(MakeSlotDataID("x", drag_data->SlotTitle, drag_data->NodeId,
-                                                         IsInputSlotKind(drag_data->SlotKind))),
-                impl->CachedData.GetFloat(MakeSlotDataID("y", drag_data->SlotTitle, drag_data->NodeId,
-                                                         IsInputSlotKind(drag_data->SlotKind))),
-            };
+        ImVec2 slot_pos;
+        GetSlotScreenPos(MakeSlotRecordID(drag_data->NodeId, drag_data->SlotId, IsInputSlotKind(drag_data->SlotKind)),
+                         &slot_pos);
 
-            float connection_indent = canvas->Style.ConnectionIndent * canvas->Zoom;
+        float connection_indent = canvas->Style.ConnectionIndent * canvas->Zoom;
 
-            ImVec2 input_pos, output_pos;
-            if (IsInputSlotKind(drag_data->SlotKind))
-            {
-                input_pos = slot_pos;
-                input_pos.x += connection_indent;
-                output_pos = ImGui::GetMousePos();
-            }
-            else
-            {
-                input_pos = ImGui::GetMousePos();
-                output_pos = slot_pos;
-                output_pos.x -= connection_indent;
-            }
-
-            RenderConnection(input_pos, output_pos, canvas->Style.CurveThickness);
+        ImVec2 input_pos, output_pos;
+        if (IsInputSlotKind(drag_data->SlotKind))
+        {
+            input_pos = slot_pos;
+            input_pos.x += connection_indent;
+            output_pos = ImGui::GetMousePos();
+        }
+        else
+        {
+            input_pos = ImGui::GetMousePos();
+            output_pos = slot_pos;
+            output_pos.x -= connection_indent;
         }
+
+        // Curve of in-progress connection is always hovered.
+        RenderConnection(input_pos, output_pos, canvas->Style.CurveThickness, true, 0, false);
     }
 
     if (impl->DoSelectionsFrame <= ImGui::GetCurrentContext()->FrameCount)
@@ -337,8 +1873,16 @@ void EndCanvas()
     {
     case State_None:
     {
-        // Set the hovered node, if there is any, for the next frame.
-        impl->HoveredNodeId = impl->PendingHoveredNodeId;
+        //
+        // Nodes are drawn from back to front, but the user interaction is rather front to back. Therefore the
+        // top-most of overlayed nodes is found once all nodes have been rendered. Set the hovered node, if there is
+        // any, for the next frame.
+        //
+        // Since we do this only in this state a node is not considered hovered when another node is dragged or an
+        // area selection is being made. A node is also not considered hovered during a pending connection (the
+        // source slot is active).
+        //
+        impl->HoveredNodeId = FindHoveredNode();
 
         ImGuiID canvas_id = ImGui::GetID("canvas");
         if (ImGui::IsMouseDown(0) && ImGui::GetCurrentWindow()->ContentRegionRect.Contains(ImGui::GetMousePos()))
@@ -395,8 +1939,28 @@ void EndCanvas()
     }
     }
 
-    // Clear this in preparation for the next frame.
-    impl->PendingHoveredNodeId = 0;
+    if (impl->RedrawFromCache)
+        EmitRedrawCache(draw_list);
+    else if (impl->RedrawCapture)
+        CaptureRedrawCache(draw_list);
+
+    impl->Layers.Merge(draw_list);
+
+    // Finalize statistics of this frame.
+    CanvasStats& stats = impl->FrameStats;
+    stats.NodesSubmitted = impl->NodeCount;
+    stats.CachedNodes = impl->Nodes.GetAliveCount();
+    stats.CachedSlots = impl->Slots.Count;
+    stats.CachedCurves = impl->Edges.GetAliveCount();
+    stats.Vertices = draw_list->VtxBuffer.Size - impl->FrameVtxStart;
+    stats.Indices = draw_list->IdxBuffer.Size - impl->FrameIdxStart;
+    stats.Allocations = (int)(gAllocationCounter.Count - impl->FrameAllocStart);
+    stats.AllocatedBytes = (int)(gAllocationCounter.Bytes - impl->FrameAllocBytesStart);
+    _StatsClock::time_point now = _StatsClock::now();
+    stats.EndCanvasTime += std::chrono::duration<float, std::milli>(now - impl->PhaseStart).count();
+    stats.TotalTime = std::chrono::duration<float, std::milli>(now - impl->FrameStart).count();
+    impl->Stats = stats;
+    gLastCanvasStats = stats;
 
     ImGui::SetWindowFontScale(1.f);
     ImGui::PopID();     // canvas
@@ -405,46 +1969,88 @@ void EndCanvas()
 
 bool BeginNode(void* node_id, ImVec2* pos, bool* selected)
 {
+    IMNODES_PROFILE_SCOPE("ImNodes::BeginNode");
     IM_ASSERT(gCanvas != nullptr);
     IM_ASSERT(node_id != nullptr);
     IM_ASSERT(pos != nullptr);
     IM_ASSERT(selected != nullptr);
     const ImGuiStyle& style = ImGui::GetStyle();
-    ImDrawList* draw_list = ImGui::GetWindowDrawList();
     auto* canvas = gCanvas;
     auto* impl = canvas->_Impl;
+    EnterCanvasPhase(Phase_Nodes);
 
     impl->Node.Id = node_id;
     impl->Node.Pos = pos;
     impl->Node.Selected = selected;
-
-    // 0 - node rect, curves
-    // 1 - node content
-    draw_list->ChannelsSplit(2);
+    impl->Node.Cache = impl->Nodes.GetOrAddByKey(MakeNodeDataID(node_id));
+    impl->Node.Culled = false;
+    impl->Node.Simplified = false;
 
     if (node_id == impl->AutoPositionNodeId)
     {
         // Somewhere out of view so that we dont see node flicker when it will be repositioned
-        ImGui::SetCursorScreenPos(ImGui::GetWindowPos() + ImGui::GetWindowSize() + style.WindowPadding);
+        impl->Node.Origin = ImGui::GetWindowPos() + ImGui::GetWindowSize() + style.WindowPadding;
     }
     else
     {
         // Top-let corner of the node
-        ImGui::SetCursorScreenPos(ImGui::GetWindowPos() + (*pos) * canvas->Zoom + canvas->Offset);
+        impl->Node.Origin = ImGui::GetWindowPos() + (*pos) * canvas->Zoom + canvas->Offset;
     }
 
     ImGui::PushID(node_id);
 
     impl->Node.ItemId = ImGui::GetID(node_id);
 
+    // Node size is known only after it was rendered at least once. Node that is a source of pending connection is always
+    // rendered, because ImGui would lose track of drag source. Node that is being interacted with is never culled, because
+    // ImGui would lose track of active item. It may be simplified, because simplified node is still an item.
+    const ImRect& cached_rect = impl->Node.Cache->Rect;
+    bool is_pending_source = impl->PendingConnection != nullptr && impl->PendingConnection->NodeId == node_id;
+    if (node_id != impl->AutoPositionNodeId && cached_rect.GetArea() > 0 && !is_pending_source)
+    {
+        impl->Node.Rect = {
+            impl->Node.Origin + cached_rect.Min * canvas->Zoom,
+            impl->Node.Origin + cached_rect.Max * canvas->Zoom
+        };
+        if (impl->RedrawFromCache)
+        {
+            // Node geometry is emitted from redraw cache. Moved or (de)selected node is rendered again on the next frame.
+            impl->Node.Culled = true;
+            const _CachedNode* cache = impl->Node.Cache;
+            if (pos->x != cache->Pos.x || pos->y != cache->Pos.y || *selected != cache->Selected)
+                impl->RedrawCache.Valid = false;
+        }
+        else if (ImGui::GetActiveID() != impl->Node.ItemId)
+        {
+            ImRect visible_rect = ImGui::GetCurrentWindow()->ClipRect;
+            visible_rect.Expand(canvas->Style.CullingMargin);
+            impl->Node.Culled = !visible_rect.Overlaps(impl->Node.Rect);
+        }
+        impl->Node.Simplified = !impl->Node.Culled && IsLodActive();
+    }
+    else if (impl->RedrawFromCache)
+    {
+        // Node is not in redraw cache.
+        impl->RedrawCache.Valid = false;
+    }
+
+    if (impl->Node.Culled)
+        impl->FrameStats.NodesCulled++;
+    if (impl->Node.Simplified)
+        impl->FrameStats.NodesSimplified++;
+    if (impl->Node.Culled || impl->Node.Simplified)
+        return false;
+
+    SetCanvasLayer(LayerNodeContent);
+    ImGui::SetCursorScreenPos(impl->Node.Origin);
     ImGui::BeginGroup();    // Slots and content group
-    draw_list->ChannelsSetCurrent(1);
 
     return true;
 }
 
 void EndNode()
 {
+    IMNODES_PROFILE_SCOPE("ImNodes::EndNode");
     IM_ASSERT(gCanvas != nullptr);
     ImDrawList* draw_list = ImGui::GetWindowDrawList();
     auto* canvas = gCanvas;
@@ -454,31 +2060,59 @@ void EndNode()
     bool& node_selected = *impl->Node.Selected;
     ImVec2& node_pos = *impl->Node.Pos;
     bool activate = false;
+    bool culled = impl->Node.Culled;
 
-    ImGui::EndGroup();    // Slots and content group
-
-    ImRect node_rect{
-        ImGui::GetItemRectMin() - canvas->Style.NodeSpacing * canvas->Zoom,
-        ImGui::GetItemRectMax() + canvas->Style.NodeSpacing * canvas->Zoom
-    };
-
-    // Render frame
-    draw_list->ChannelsSetCurrent(0);
+    bool simplified = impl->Node.Simplified;
+    ImGuiID node_item_id = impl->Node.ItemId;
 
-    ImColor node_color = canvas->Colors[node_selected ? ColNodeActiveBg : ColNodeBg];
-    draw_list->AddRectFilled(node_rect.Min, node_rect.Max, node_color, canvas->Style.NodeRounding * canvas->Zoom);
-    draw_list->AddRect(node_rect.Min, node_rect.Max, canvas->Colors[ColNodeBorder], canvas->Style.NodeRounding * canvas->Zoom);
+    ImRect node_rect;
+    if (culled)
+    {
+        // Node was not submitted. Rect predicted from previous frame is good enough for selection and dragging.
+        node_rect = impl->Node.Rect;
+    }
+    else if (simplified)
+    {
+        // Node content was not submitted. Node is rendered as a plain rect of the size it had on last full render.
+        node_rect = impl->Node.Rect;
+        ImColor node_color = canvas->Colors[node_selected ? ColNodeActiveBg : ColNodeBg];
+        SetCanvasLayer(LayerNodeBg);
+        draw_list->AddRectFilled(node_rect.Min, node_rect.Max, node_color);
+        SetCanvasLayer(LayerNodeContent);
+
+        ImGui::SetCursorScreenPos(node_rect.Min);
+        ImGui::ItemSize(node_rect.GetSize());
+        ImGui::ItemAdd(node_rect, node_item_id);
+    }
+    else
+    {
+        ImGui::EndGroup();    // Slots and content group
+
+        node_rect = {
+            ImGui::GetItemRectMin() - canvas->Style.NodeSpacing * canvas->Zoom,
+            ImGui::GetItemRectMax() + canvas->Style.NodeSpacing * canvas->Zoom
+        };
+
+        // Render frame
+        SetCanvasLayer(LayerNodeBg);
+        ImColor node_color = canvas->Colors[node_selected ? ColNodeActiveBg : ColNodeBg];
+        draw_list->AddRectFilled(node_rect.Min, node_rect.Max, node_color, canvas->Style.NodeRounding * canvas->Zoom);
+        draw_list->AddRect(node_rect.Min, node_rect.Max, canvas->Colors[ColNodeBorder], canvas->Style.NodeRounding * canvas->Zoom);
+        SetCanvasLayer(LayerNodeContent);
+
+        // Create node item
+        ImGui::ItemSize(node_rect.GetSize());
+        ImGui::ItemAdd(node_rect, node_item_id);
+    }
 
-    // Create node item
-    ImGuiID node_item_id = impl->Node.ItemId;
-    ImGui::ItemSize(node_rect.GetSize());
-    ImGui::ItemAdd(node_rect, node_item_id);
+    // Culled node is not an item, it can not be hovered or active.
+    bool item_hovered = !culled && ImGui::IsItemHovered();
+    bool item_active = !culled && ImGui::IsItemActive();
 
     // Save last selection state in case we are about to start dragging multiple selected nodes
     if (ImGui::IsMouseClicked(0))
     {
-        ImGuiID prev_selected_id = ImHashStr("prev-selected", 0, ImHashData(&impl->Node.Id, sizeof(impl->Node.Id)));
-        impl->CachedData.SetBool(prev_selected_id, node_selected);
+        impl->Node.Cache->PrevSelected = node_selected;
     }
 
     ImGuiIO& io = ImGui::GetIO();
@@ -486,19 +2120,6 @@ void EndNode()
     {
     case State_None:
     {
-        //
-        // Nodes are drawn from back to front, but the user interaction is rather front to back. Therefore the
-        // top-most of overlayed nodes will not be known until all nodes have been rendered. So we continuously
-        // save the potential top-most node and thus overwrite the previous candidate. The final top-most node
-        // is known once EndCanvas() is called.
-        //
-        // Since we do this only in this state a node is not considered hovered when another node is dragged
-        // or an area selection is being made. Also, since IsItemHovered() is not called with any flags a node is
-        // not considered hovered during a pending connection (the source slot is active).
-        //
-        if (ImGui::IsItemHovered())
-            impl->PendingHoveredNodeId = node_item_id;
-
         // Node selection behavior. Selection can change only when no node is being dragged and connections are not being made.
         if (impl->JustConnected || ImGui::GetDragDropPayload() != nullptr)
         {
@@ -519,7 +2140,7 @@ void EndNode()
             else
                 node_selected = false;
         }
-        else if (ImGui::IsMouseDown(0) && !ImGui::IsAnyItemActive() && ImGui::IsItemHovered())
+        else if (ImGui::IsMouseDown(0) && !ImGui::IsAnyItemActive() && item_hovered)
         {
             // Nodes are drawn from back to front, but the user interaction is rather front to back. Therefore the
             // top-most of overlayed nodes will not be known until all nodes have been rendered. So we continuously
@@ -527,7 +2148,7 @@ void EndNode()
             // is known once EndCanvas() is called.
             activate = true;
         }
-        else if (ImGui::IsMouseReleased(0) && ImGui::IsItemHovered() && ImGui::IsItemActive())
+        else if (ImGui::IsMouseReleased(0) && item_hovered && item_active)
         {
             if (!io.KeyCtrl)
             {
@@ -537,7 +2158,7 @@ void EndNode()
             else
                 node_selected ^= true;
         }
-        else if (ImGui::IsItemActive() && ImGui::IsMouseDragging(0))
+        else if (item_active && ImGui::IsMouseDragging(0))
         {
             impl->State = State_Drag;
             if (impl->DragNode == nullptr)
@@ -562,40 +2183,35 @@ void EndNode()
         if (ImGui::IsMouseDown(0))
         {
             // Node dragging behavior. Drag node under mouse and other selected nodes if current node is selected.
-            if ((ImGui::IsItemActive() || (impl->DragNode && impl->DragNodeSelected && node_selected)))
+            if ((item_active || (impl->DragNode && impl->DragNodeSelected && node_selected)))
                 node_pos += ImGui::GetIO().MouseDelta / canvas->Zoom;
         }
         break;
     }
     case State_Select:
     {
-        ImRect selection_rect;
-        selection_rect.Min.x = ImMin(impl->SelectionStart.x, ImGui::GetMousePos().x);
-        selection_rect.Min.y = ImMin(impl->SelectionStart.y, ImGui::GetMousePos().y);
-        selection_rect.Max.x = ImMax(impl->SelectionStart.x, ImGui::GetMousePos().x);
-        selection_rect.Max.y = ImMax(impl->SelectionStart.y, ImGui::GetMousePos().y);
-
-        ImGuiID prev_selected_id = ImHashStr("prev-selected", 0, ImHashData(&impl->Node.Id, sizeof(impl->Node.Id)));
+        // Nodes inside selection rect were found by BeginCanvas().
+        bool in_selection_rect = impl->Node.Cache->SelectionFrame == ImGui::GetCurrentContext()->FrameCount;
         if (io.KeyShift)
         {
             // Append selection
-            if (selection_rect.Contains(node_rect))
+            if (in_selection_rect)
                 node_selected = true;
             else
-                node_selected = impl->CachedData.GetBool(prev_selected_id);
+                node_selected = impl->Node.Cache->PrevSelected;
         }
         else if (io.KeyCtrl)
         {
             // Subtract from selection
-            if (selection_rect.Contains(node_rect))
+            if (in_selection_rect)
                 node_selected = false;
             else
-                node_selected = impl->CachedData.GetBool(prev_selected_id);
+                node_selected = impl->Node.Cache->PrevSelected;
         }
         else
         {
             // Assign selection
-            node_selected = selection_rect.Contains(node_rect);
+            node_selected = in_selection_rect;
         }
         break;
     }
@@ -610,17 +2226,38 @@ void EndNode()
     else if (activate)
         impl->PendingActiveItemId = node_item_id;
 
-    draw_list->ChannelsMerge();
-
-    if (!ImGui::IsMouseDown(0) && ImGui::IsItemActive())
+    if (!culled && !ImGui::IsMouseDown(0) && item_active)
         ImGui::ClearActiveID();
 
+    if (!culled && !simplified)
+    {
+        // Remember node geometry for culling it on the next frame.
+        impl->Node.Cache->Rect = {
+            (node_rect.Min - impl->Node.Origin) / canvas->Zoom,
+            (node_rect.Max - impl->Node.Origin) / canvas->Zoom
+        };
+        impl->Node.Cache->LastRenderedFrame = ImGui::GetCurrentContext()->FrameCount;
+    }
+    impl->Node.Cache->LastFrame = ImGui::GetCurrentContext()->FrameCount;
+    impl->Node.Cache->Pos = node_pos;
+    impl->Node.Cache->Selected = node_selected;
+    impl->Node.Cache->Id = node_id;
+    impl->Node.Cache->ItemId = node_item_id;
+    impl->Node.Cache->Order = impl->NodeCount++;
+    impl->NodeGrid.Insert(impl->Nodes.GetIndex(impl->Node.Cache), impl->Node.Cache->GetCanvasRect());
+
     if (node_selected)
         impl->CurrSelectCount++;
 
     ImGui::PopID();     // id
 }
 
+bool IsNodeSimplified()
+{
+    IM_ASSERT(gCanvas != nullptr);
+    return gCanvas->_Impl->Node.Simplified;
+}
+
 bool IsNodeHovered()
 {
     assert(gCanvas != nullptr);
@@ -630,20 +2267,38 @@ bool IsNodeHovered()
 bool GetNewConnection(void** input_node, const char** input_slot_title, void** output_node, const char** output_slot_title)
 {
     IM_ASSERT(gCanvas != nullptr);
-    IM_ASSERT(input_node != nullptr);
     IM_ASSERT(input_slot_title != nullptr);
-    IM_ASSERT(output_node != nullptr);
     IM_ASSERT(output_slot_title != nullptr);
 
+    auto* impl = gCanvas->_Impl;
+    const char* input_slot = impl->NewConnection.InputSlot;
+    const char* output_slot = impl->NewConnection.OutputSlot;
+    ImGuiID input_slot_id, output_slot_id;
+    if (!GetNewConnectionById(input_node, &input_slot_id, output_node, &output_slot_id))
+        return false;
+
+    *input_slot_title = input_slot;
+    *output_slot_title = output_slot;
+    return true;
+}
+
+bool GetNewConnectionById(void** input_node, ImGuiID* input_slot_id, void** output_node, ImGuiID* output_slot_id)
+{
+    IM_ASSERT(gCanvas != nullptr);
+    IM_ASSERT(input_node != nullptr);
+    IM_ASSERT(input_slot_id != nullptr);
+    IM_ASSERT(output_node != nullptr);
+    IM_ASSERT(output_slot_id != nullptr);
+
     auto* canvas = gCanvas;
     auto* impl = canvas->_Impl;
 
     if (impl->NewConnection.OutputNode != nullptr)
     {
         *input_node = impl->NewConnection.InputNode;
-        *input_slot_title = impl->NewConnection.InputSlot;
+        *input_slot_id = impl->NewConnection.InputSlotId;
         *output_node = impl->NewConnection.OutputNode;
-        *output_slot_title = impl->NewConnection.OutputSlot;
+        *output_slot_id = impl->NewConnection.OutputSlotId;
         impl->NewConnection = {};
         return true;
     }
@@ -651,6 +2306,12 @@ bool GetNewConnection(void** input_node, const char** input_slot_title, void** o
     return false;
 }
 
+/// Returns payload of connection that is being made, or null if there is none.
+const _DragConnectionPayload* GetPendingConnectionPayload()
+{
+    return gCanvas->_Impl->PendingConnection;
+}
+
 bool GetPendingConnection(void** node_id, const char** slot_title, int* slot_kind)
 {
     IM_ASSERT(gCanvas != nullptr);
@@ -658,95 +2319,245 @@ bool GetPendingConnection(void** node_id, const char** slot_title, int* slot_kin
     IM_ASSERT(slot_title != nullptr);
     IM_ASSERT(slot_kind != nullptr);
 
-    if (auto* payload = ImGui::GetDragDropPayload())
+    if (const _DragConnectionPayload* drag_payload = GetPendingConnectionPayload())
     {
-        char drag_id[] = "new-node-connection-";
-        if (strncmp(drag_id, payload->DataType, sizeof(drag_id) - 1) == 0)
-        {
-            auto* drag_payload = (_DragConnectionPayload*)payload->Data;
-            *node_id = drag_payload->NodeId;
-            *slot_title = drag_payload->SlotTitle;
-            *slot_kind = drag_payload->SlotKind;
-            return true;
-        }
+        *node_id = drag_payload->NodeId;
+        *slot_title = drag_payload->SlotTitle;
+        *slot_kind = drag_payload->SlotKind;
+        return true;
     }
 
     return false;
 }
 
-bool Connection(void* input_node, const char* input_slot, void* output_node, const char* output_slot)
+bool GetPendingConnectionById(void** node_id, ImGuiID* slot_id, int* slot_kind)
 {
     IM_ASSERT(gCanvas != nullptr);
+    IM_ASSERT(node_id != nullptr);
+    IM_ASSERT(slot_id != nullptr);
+    IM_ASSERT(slot_kind != nullptr);
+
+    if (const _DragConnectionPayload* drag_payload = GetPendingConnectionPayload())
+    {
+        *node_id = drag_payload->NodeId;
+        *slot_id = drag_payload->SlotId;
+        *slot_kind = drag_payload->SlotKind;
+        return true;
+    }
+
+    return false;
+}
+
+/// Per-frame state shared by connections submitted together.
+struct _ConnectionBatch
+{
+    /// Screen position of canvas origin.
+    ImVec2 Origin{};
+    /// Canvas zoom.
+    float Zoom = 1.0f;
+    /// Indent of connection into slot widget, in pixels.
+    float Indent = 0.0f;
+    /// Payload of connection that is being made, null if there is none.
+    const _DragConnectionPayload* Pending = nullptr;
+    /// Flag indicating that hovered connection is being deleted.
+    bool DeleteHovered = false;
+};
+
+_ConnectionBatch MakeConnectionBatch()
+{
+    auto* canvas = gCanvas;
+    _ConnectionBatch batch{};
+    batch.Origin = ImGui::GetWindowPos() + canvas->Offset;
+    batch.Zoom = canvas->Zoom;
+    batch.Indent = canvas->Style.ConnectionIndent * canvas->Zoom;
+    batch.Pending = canvas->_Impl->PendingConnection;
+    batch.DeleteHovered = ImGui::IsWindowHovered() && ImGui::IsMouseDoubleClicked(0);
+    return batch;
+}
+
+/// Finds screen positions of connection ends. Returns `false` if connection is not rendered on current frame.
+bool ResolveConnection(const _ConnectionBatch& batch, void* input_node, ImGuiID input_slot_id, void* output_node,
+    ImGuiID output_slot_id, _ResolvedConnection* resolved)
+{
     IM_ASSERT(input_node != nullptr);
-    IM_ASSERT(input_slot != nullptr);
     IM_ASSERT(output_node != nullptr);
-    IM_ASSERT(output_slot != nullptr);
 
-    bool is_connected = true;
-    auto* canvas = gCanvas;
-    auto* impl = canvas->_Impl;
+    auto* impl = gCanvas->_Impl;
 
     if (input_node == impl->AutoPositionNodeId || output_node == impl->AutoPositionNodeId)
         // Do not render connection to newly added output node because node is rendered outside of screen on the first frame and will be repositioned.
-        return is_connected;
+        return false;
 
-    ImVec2 input_slot_pos{
-        impl->CachedData.GetFloat(MakeSlotDataID("x", input_slot, input_node, true)),
-        impl->CachedData.GetFloat(MakeSlotDataID("y", input_slot, input_node, true)),
-    };
+    impl->FrameStats.ConnectionsSubmitted++;
+    if (impl->RedrawFromCache)
+        // Curve is emitted from redraw cache.
+        return false;
 
-    ImVec2 output_slot_pos{
-        impl->CachedData.GetFloat(MakeSlotDataID("x", output_slot, output_node, false)),
-        impl->CachedData.GetFloat(MakeSlotDataID("y", output_slot, output_node, false)),
-    };
+    ImGuiID input_record_id = MakeSlotRecordID(input_node, input_slot_id, true);
+    ImGuiID output_record_id = MakeSlotRecordID(output_node, output_slot_id, false);
+
+    if (const _DragConnectionPayload* pending = batch.Pending)
+    {
+        // Slot on the other end of existing connection can not be connected again.
+        if (IsInputSlotKind(pending->SlotKind))
+        {
+            if (pending->NodeId == input_node && pending->SlotId == input_slot_id)
+                impl->IgnoreConnections.Add({output_node, output_slot_id, false}, output_record_id);
+        }
+        else
+        {
+            if (pending->NodeId == output_node && pending->SlotId == output_slot_id)
+                impl->IgnoreConnections.Add({input_node, input_slot_id, true}, input_record_id);
+        }
+    }
+
+    const _SlotRecord* input_record = impl->Slots.Find(input_record_id);
+    const _SlotRecord* output_record = impl->Slots.Find(output_record_id);
+    if (input_record == nullptr || output_record == nullptr)
+        // Slots were not rendered yet, position of connection is unknown.
+        return false;
+
+    resolved->InputPos = batch.Origin + (input_record->Pos + impl->Nodes.GetByIndex(input_record->NodeIndex)->Pos) * batch.Zoom;
+    resolved->OutputPos = batch.Origin + (output_record->Pos + impl->Nodes.GetByIndex(output_record->NodeIndex)->Pos) * batch.Zoom;
 
     // Indent connection a bit into slot widget.
-    float connection_indent = canvas->Style.ConnectionIndent * canvas->Zoom;
-    input_slot_pos.x += connection_indent;
-    output_slot_pos.x -= connection_indent;
+    resolved->InputPos.x += batch.Indent;
+    resolved->OutputPos.x -= batch.Indent;
+
+    ImGuiID edge_id = ImHashData(&output_record_id, sizeof(output_record_id), input_record_id);
+    resolved->EdgeId = edge_id ? edge_id : 1;
+    return true;
+}
+
+/// Culls and renders a resolved connection, or queues it for rendering when `defer` is set. Slot titles are optional
+/// and only stored for reporting hovered connection. Returns `false` if connection was deleted.
+bool DrawConnection(const _ConnectionBatch& batch, const _ResolvedConnection& resolved, void* input_node,
+    ImGuiID input_slot_id, const char* input_slot, void* output_node, ImGuiID output_slot_id, const char* output_slot,
+    bool defer)
+{
+    auto* canvas = gCanvas;
+    auto* impl = canvas->_Impl;
 
-    bool curve_hovered = RenderConnection(input_slot_pos, output_slot_pos, canvas->Style.CurveThickness);
-    if (curve_hovered && ImGui::IsWindowHovered())
+    // Only one curve nearest to the mouse cursor can be hovered.
+    bool curve_hovered = impl->HoveredCurve.IsSameConnection(input_node, input_slot_id, output_node, output_slot_id);
+    if (RenderConnection(resolved.InputPos, resolved.OutputPos, canvas->Style.CurveThickness, curve_hovered,
+        resolved.EdgeId, defer))
     {
-        if (ImGui::IsMouseDoubleClicked(0))
-            is_connected = false;
+        impl->FrameStats.ConnectionsDrawn++;
+        // Store visible curve for finding hovered curve at the end of the frame.
+        _CachedCurve curve{};
+        curve.InputNode = input_node;
+        curve.InputSlotId = input_slot_id;
+        curve.InputSlot = input_slot;
+        curve.OutputNode = output_node;
+        curve.OutputSlotId = output_slot_id;
+        curve.OutputSlot = output_slot;
+        curve.Thickness = canvas->Style.CurveThickness;
+        GetConnectionCurve(ScreenToCanvas(resolved.InputPos), ScreenToCanvas(resolved.OutputPos),
+            canvas->Style.CurveStrength, curve.P);
+        impl->CurveGrid.Insert(impl->Curves.Size, GetCurveRect(curve.P, curve.Thickness));
+        impl->Curves.push_back(curve);
     }
 
-    impl->CachedData.SetFloat(MakeSlotDataID("hovered", input_slot, input_node, true), curve_hovered && is_connected);
-    impl->CachedData.SetFloat(MakeSlotDataID("hovered", output_slot, output_node, false), curve_hovered && is_connected);
+    return !(curve_hovered && batch.DeleteHovered);
+}
+
+/// Renders a single connection to curves layer.
+bool ConnectionImpl(void* input_node, ImGuiID input_slot_id, const char* input_slot, void* output_node,
+    ImGuiID output_slot_id, const char* output_slot)
+{
+    IMNODES_PROFILE_SCOPE("ImNodes::Connection");
+    IM_ASSERT(gCanvas != nullptr);
+    EnterCanvasPhase(Phase_Connections);
+    _ConnectionBatch batch = MakeConnectionBatch();
+    _ResolvedConnection resolved;
+    if (!ResolveConnection(batch, input_node, input_slot_id, output_node, output_slot_id, &resolved))
+        return true;
+
+    CanvasLayer prev_layer = SetCanvasLayer(LayerCurves);
+    bool is_connected = DrawConnection(batch, resolved, input_node, input_slot_id, input_slot, output_node,
+        output_slot_id, output_slot, gCanvas->DeferredCurves);
+    SetCanvasLayer(prev_layer);
+    return is_connected;
+}
+
+bool Connection(void* input_node, const char* input_slot, void* output_node, const char* output_slot)
+{
+    IM_ASSERT(input_slot != nullptr);
+    IM_ASSERT(output_slot != nullptr);
+    return ConnectionImpl(input_node, ImHashStr(input_slot), input_slot, output_node, ImHashStr(output_slot), output_slot);
+}
+
+bool Connection(void* input_node, ImGuiID input_slot_id, void* output_node, ImGuiID output_slot_id)
+{
+    return ConnectionImpl(input_node, input_slot_id, nullptr, output_node, output_slot_id, nullptr);
+}
+
+int Connections(const ConnectionDesc* edges, int count, bool* out_deleted)
+{
+    IMNODES_PROFILE_SCOPE("ImNodes::Connections");
+    IM_ASSERT(gCanvas != nullptr);
+    IM_ASSERT(edges != nullptr || count == 0);
 
-    void* pending_node_id;
-    const char* pending_slot_title;
-    int pending_slot_kind;
-    if (GetPendingConnection(&pending_node_id, &pending_slot_title, &pending_slot_kind))
+    auto* canvas = gCanvas;
+    auto* impl = canvas->_Impl;
+    EnterCanvasPhase(Phase_Connections);
+    _ConnectionBatch batch = MakeConnectionBatch();
+    if (out_deleted != nullptr)
+        memset(out_deleted, 0, sizeof(bool) * count);
+
+    // Ends of all connections are looked up in slot table first.
+    ImVector<_ResolvedConnection>& resolved = impl->ResolvedConnections;
+    resolved.resize(0);
+    if (count > resolved.Capacity)
+        resolved.reserve(resolved._grow_capacity(count));
+    for (int i = 0; i < count; i++)
     {
-        _IgnoreSlot ignore_connection{};
-        if (IsInputSlotKind(pending_slot_kind))
-        {
-            if (pending_node_id == input_node && strcmp(pending_slot_title, input_slot) == 0)
-            {
-                ignore_connection.NodeId = output_node;
-                ignore_connection.SlotName = output_slot;
-                ignore_connection.SlotKind = OutputSlotKind(1);
-            }
-        }
-        else
+        const ConnectionDesc& edge = edges[i];
+        _ResolvedConnection connection;
+        if (ResolveConnection(batch, edge.InputNode, edge.InputSlot, edge.OutputNode, edge.OutputSlot, &connection))
         {
-            if (pending_node_id == output_node && strcmp(pending_slot_title, output_slot) == 0)
-            {
-                ignore_connection.NodeId = input_node;
-                ignore_connection.SlotName = input_slot;
-                ignore_connection.SlotKind = InputSlotKind(1);
-            }
+            connection.Index = i;
+            resolved.push_back(connection);
         }
-        if (ignore_connection.NodeId)
+    }
+    if (resolved.empty())
+        return 0;
+
+    // Curves are culled and their cached or tessellated geometry is queued.
+    CanvasLayer prev_layer = SetCanvasLayer(LayerCurves);
+    if (impl->Curves.Size + resolved.Size > impl->Curves.Capacity)
+        impl->Curves.reserve(impl->Curves._grow_capacity(impl->Curves.Size + resolved.Size));
+    int deleted_count = 0;
+    for (const _ResolvedConnection& connection : resolved)
+    {
+        const ConnectionDesc& edge = edges[connection.Index];
+        if (!DrawConnection(batch, connection, edge.InputNode, edge.InputSlot, nullptr, edge.OutputNode, edge.OutputSlot,
+            nullptr, true))
         {
-            if (!impl->IgnoreConnections.contains(ignore_connection))
-                impl->IgnoreConnections.push_back(ignore_connection);
+            if (out_deleted != nullptr)
+                out_deleted[connection.Index] = true;
+            deleted_count++;
         }
     }
 
-    return is_connected;
+    // Queued geometry is emitted together. With CanvasState::DeferredCurves it is emitted by EndCanvas() along with
+    // curves of other calls.
+    if (!canvas->DeferredCurves)
+        RenderDeferredCurves(ImGui::GetWindowDrawList(), false);
+
+    SetCanvasLayer(prev_layer);
+    return deleted_count;
+}
+
+CanvasLayer SetCanvasLayer(CanvasLayer layer)
+{
+    IM_ASSERT(gCanvas != nullptr);
+    ImDrawListSplitter& layers = gCanvas->_Impl->Layers;
+    auto prev_layer = (CanvasLayer)layers._Current;
+    if (prev_layer != layer)
+        layers.SetCurrentChannel(ImGui::GetWindowDrawList(), layer);
+    return prev_layer;
 }
 
 CanvasState* GetCurrentCanvas()
@@ -754,13 +2565,114 @@ CanvasState* GetCurrentCanvas()
     return gCanvas;
 }
 
+static void* CountingAlloc(size_t size, void* user_data)
+{
+    auto* counter = (_AllocationCounter*)user_data;
+    counter->Count++;
+    counter->Bytes += size;
+    return counter->AllocFunc(size, counter->UserData);
+}
+
+static void CountingFree(void* ptr, void* user_data)
+{
+    auto* counter = (_AllocationCounter*)user_data;
+    counter->FreeFunc(ptr, counter->UserData);
+}
+
+void EnableAllocationCounter()
+{
+    if (gAllocationCounter.AllocFunc != nullptr)
+        return;
+    ImGui::GetAllocatorFunctions(&gAllocationCounter.AllocFunc, &gAllocationCounter.FreeFunc, &gAllocationCounter.UserData);
+    ImGui::SetAllocatorFunctions(&CountingAlloc, &CountingFree, &gAllocationCounter);
+}
+
+const CanvasStats& GetCanvasStats(const CanvasState* canvas)
+{
+    if (canvas == nullptr)
+        return gLastCanvasStats;
+    return canvas->_Impl->Stats;
+}
+
+bool GetHoveredConnection(void** input_node, const char** input_slot, void** output_node, const char** output_slot)
+{
+    IM_ASSERT(gCanvas != nullptr);
+    IM_ASSERT(input_node != nullptr);
+    IM_ASSERT(input_slot != nullptr);
+    IM_ASSERT(output_node != nullptr);
+    IM_ASSERT(output_slot != nullptr);
+
+    const _CachedCurve& curve = gCanvas->_Impl->HoveredCurve;
+    if (curve.InputNode == nullptr)
+        return false;
+
+    *input_node = curve.InputNode;
+    *input_slot = curve.InputSlot;
+    *output_node = curve.OutputNode;
+    *output_slot = curve.OutputSlot;
+    return true;
+}
+
+bool GetHoveredConnectionById(void** input_node, ImGuiID* input_slot_id, void** output_node, ImGuiID* output_slot_id)
+{
+    IM_ASSERT(gCanvas != nullptr);
+    IM_ASSERT(input_node != nullptr);
+    IM_ASSERT(input_slot_id != nullptr);
+    IM_ASSERT(output_node != nullptr);
+    IM_ASSERT(output_slot_id != nullptr);
+
+    const _CachedCurve& curve = gCanvas->_Impl->HoveredCurve;
+    if (curve.InputNode == nullptr)
+        return false;
+
+    *input_node = curve.InputNode;
+    *input_slot_id = curve.InputSlotId;
+    *output_node = curve.OutputNode;
+    *output_slot_id = curve.OutputSlotId;
+    return true;
+}
+
+int FindNodesInRect(const ImVec2& rect_min, const ImVec2& rect_max, void** node_ids, int max_count)
+{
+    IM_ASSERT(gCanvas != nullptr);
+    IM_ASSERT(node_ids != nullptr || max_count == 0);
+
+    auto* impl = gCanvas->_Impl;
+    const ImVector<int>& nodes = QueryNodes({rect_min, rect_max});
+    for (int i = 0; i < nodes.Size && i < max_count; i++)
+        node_ids[i] = impl->Nodes.GetByIndex(nodes[i])->Id;
+    return nodes.Size;
+}
+
 bool BeginSlot(const char* title, int kind)
+{
+    IM_ASSERT(title != nullptr);
+    bool result = BeginSlot(ImHashStr(title), kind);
+    gCanvas->_Impl->slot.Title = title;
+    return result;
+}
+
+bool BeginSlot(ImGuiID slot_id, int kind)
 {
     auto* canvas = gCanvas;
     auto* impl = canvas->_Impl;
 
-    impl->slot.Title = title;
+    impl->slot.Id = slot_id;
+    impl->slot.Title = nullptr;
     impl->slot.Kind = kind;
+    impl->FrameStats.SlotsProcessed++;
+
+    // Records of slots whose node is no longer rendered or which were not rendered on last render of their node are
+    // dropped when table grows. Slots rendered on current frame are kept, their node may not be ended yet.
+    int frame = ImGui::GetCurrentContext()->FrameCount;
+    auto is_alive = [impl, frame](const _SlotRecord& record) {
+        if (record.LastFrame == frame)
+            return true;
+        const _CachedNode* node = impl->Nodes.GetByIndex(record.NodeIndex);
+        return node->LastFrame >= frame - 1 && record.LastFrame >= node->LastRenderedFrame;
+    };
+    impl->slot.Record = impl->Slots.FindOrAdd(MakeSlotRecordID(impl->Node.Id, slot_id, IsInputSlotKind(kind)), is_alive);
+    impl->slot.Record->NodeIndex = impl->Nodes.GetIndex(impl->Node.Cache);
 
     ImGui::BeginGroup();
     return true;
@@ -768,26 +2680,27 @@ bool BeginSlot(const char* title, int kind)
 
 void EndSlot()
 {
+    IMNODES_PROFILE_SCOPE("ImNodes::EndSlot");
     auto* canvas = gCanvas;
     auto* impl = canvas->_Impl;
 
     ImGui::EndGroup();
 
-    ImGui::PushID(impl->slot.Title);
     ImGui::PushID(impl->slot.Kind);
+    ImGuiID slot_item_id = ImGui::GetCurrentWindow()->GetID((int)impl->slot.Id);
 
     ImRect slot_rect{ImGui::GetItemRectMin(), ImGui::GetItemRectMax()};
     // This here adds extra line between slots because after user renders slot cursor is already past those items.
     // ImGui::ItemSize(slot_rect.GetSize());
-    ImGui::ItemAdd(slot_rect, ImGui::GetID(impl->slot.Title));
+    ImGui::ItemAdd(slot_rect, slot_item_id);
 
     if (ImGui::IsMouseClicked(0) && ImGui::IsItemHovered())
-        impl->PendingActiveSlotId = ImGui::GetID(impl->slot.Title);
+        impl->PendingActiveSlotId = slot_item_id;
 
     if (ImGui::IsItemActive() && !ImGui::IsMouseDown(0))
         ImGui::ClearActiveID();
 
-    // Store slot edge positions, curves will connect there
+    // Store slot edge positions relative to the node, curves will connect there
     {
         float x;
         if (IsInputSlotKind(impl->slot.Kind))
@@ -795,43 +2708,37 @@ void EndSlot()
         else
             x = slot_rect.Max.x;
 
-        impl->CachedData.SetFloat(MakeSlotDataID("x", impl->slot.Title, impl->Node.Id, IsInputSlotKind(impl->slot.Kind)), x);
-        impl->CachedData.SetFloat(MakeSlotDataID("y", impl->slot.Title, impl->Node.Id, IsInputSlotKind(impl->slot.Kind)),
-            slot_rect.Max.y - slot_rect.GetHeight() / 2);
+        impl->slot.Record->Pos = (ImVec2{x, slot_rect.Max.y - slot_rect.GetHeight() / 2} - impl->Node.Origin) / canvas->Zoom;
+        impl->slot.Record->LastFrame = ImGui::GetCurrentContext()->FrameCount;
     }
 
-    if (ImGui::BeginDragDropSource())
+    // Slots without a title have nothing to show in drag preview tooltip.
+    if (ImGui::BeginDragDropSource(impl->slot.Title ? 0 : ImGuiDragDropFlags_SourceNoPreviewTooltip))
     {
-        auto* payload = ImGui::GetDragDropPayload();
-        char drag_id[32];
-        snprintf(drag_id, sizeof(drag_id), "new-node-connection-%08X", impl->slot.Kind);
-        if (payload == nullptr || !payload->IsDataType(drag_id))
+        if (impl->PendingConnection == nullptr || impl->PendingConnection->SlotKind != impl->slot.Kind)
         {
             _DragConnectionPayload drag_data{ };
             drag_data.NodeId = impl->Node.Id;
             drag_data.SlotKind = impl->slot.Kind;
+            drag_data.SlotId = impl->slot.Id;
             drag_data.SlotTitle = impl->slot.Title;
 
-            ImGui::SetDragDropPayload(drag_id, &drag_data, sizeof(drag_data));
+            ImGui::SetDragDropPayload(GetPayloadType(impl->slot.Kind), &drag_data, sizeof(drag_data));
+            UpdatePendingConnection();
 
             // Clear new connection info
-            impl->NewConnection.InputNode = nullptr;
-            impl->NewConnection.InputSlot = nullptr;
-            impl->NewConnection.OutputNode = nullptr;
-            impl->NewConnection.OutputSlot = nullptr;
-            canvas->_Impl->IgnoreConnections.clear();
+            impl->NewConnection = {};
+            canvas->_Impl->IgnoreConnections.Clear();
         }
-        ImGui::TextUnformatted(impl->slot.Title);
+        if (impl->slot.Title != nullptr)
+            ImGui::TextUnformatted(impl->slot.Title);
         ImGui::EndDragDropSource();
     }
 
     if (IsConnectingCompatibleSlot() && ImGui::BeginDragDropTarget())
     {
         // Accept drags from opposite type (input <-> output, and same kind)
-        char drag_id[32];
-        snprintf(drag_id, sizeof(drag_id), "new-node-connection-%08X", impl->slot.Kind * -1);
-
-        if (auto* payload = ImGui::AcceptDragDropPayload(drag_id))
+        if (auto* payload = ImGui::AcceptDragDropPayload(GetPayloadType(impl->slot.Kind * -1)))
         {
             auto* drag_data = (_DragConnectionPayload*) payload->Data;
 
@@ -839,26 +2746,29 @@ void EndSlot()
             if (!IsInputSlotKind(impl->slot.Kind))
             {
                 impl->NewConnection.InputNode = drag_data->NodeId;
+                impl->NewConnection.InputSlotId = drag_data->SlotId;
                 impl->NewConnection.InputSlot = drag_data->SlotTitle;
                 impl->NewConnection.OutputNode = impl->Node.Id;
+                impl->NewConnection.OutputSlotId = impl->slot.Id;
                 impl->NewConnection.OutputSlot = impl->slot.Title;
             }
             else
             {
                 impl->NewConnection.InputNode = impl->Node.Id;
+                impl->NewConnection.InputSlotId = impl->slot.Id;
                 impl->NewConnection.InputSlot = impl->slot.Title;
                 impl->NewConnection.OutputNode = drag_data->NodeId;
+                impl->NewConnection.OutputSlotId = drag_data->SlotId;
                 impl->NewConnection.OutputSlot = drag_data->SlotTitle;
             }
             impl->JustConnected = true;
-            canvas->_Impl->IgnoreConnections.clear();
+            canvas->_Impl->IgnoreConnections.Clear();
         }
 
         ImGui::EndDragDropTarget();
     }
 
     ImGui::PopID(); // kind
-    ImGui::PopID(); // name
 }
 
 void AutoPositionNode(void* node_id)
@@ -873,19 +2783,15 @@ bool IsSlotCurveHovered()
     auto* canvas = gCanvas;
     auto* impl = canvas->_Impl;
 
-    void* node_id;
-    const char* slot_title;
-    int slot_kind;
-    if (ImNodes::GetPendingConnection(&node_id, &slot_title, &slot_kind))
+    if (const _DragConnectionPayload* pending = GetPendingConnectionPayload())
     {
         // In-progress connection to current slot is hovered
-        return node_id == impl->Node.Id && strcmp(slot_title, impl->slot.Title) == 0 &&
-               slot_kind == impl->slot.Kind;
+        return pending->NodeId == impl->Node.Id && pending->SlotId == impl->slot.Id &&
+               pending->SlotKind == impl->slot.Kind;
     }
 
     // Actual curve is hovered
-    return impl->CachedData.GetBool(MakeSlotDataID("hovered", impl->slot.Title, impl->Node.Id,
-                                                   IsInputSlotKind(impl->slot.Kind)));
+    return impl->slot.Record->Hovered;
 }
 
 bool IsConnectingCompatibleSlot()
@@ -894,28 +2800,18 @@ bool IsConnectingCompatibleSlot()
     auto* canvas = gCanvas;
     auto* impl = canvas->_Impl;
 
-    if (auto* payload = ImGui::GetDragDropPayload())
+    if (const _DragConnectionPayload* drag_payload = impl->PendingConnection)
     {
-        auto* drag_payload = (_DragConnectionPayload*)payload->Data;
-
         if (drag_payload->NodeId == impl->Node.Id)
             // Node can not connect to itself
             return false;
 
-        char drag_id[32];
-        snprintf(drag_id, sizeof(drag_id), "new-node-connection-%08X", impl->slot.Kind * -1);
-        if (strcmp(drag_id, payload->DataType) != 0)
+        // Connections are made between slots of opposite type (input <-> output, and same kind)
+        if (drag_payload->SlotKind != impl->slot.Kind * -1)
             return false;
 
-        for (int i = 0; i < impl->IgnoreConnections.size(); i++)
-        {
-            const _IgnoreSlot& ignored = impl->IgnoreConnections[i];
-            if (ignored.NodeId == impl->Node.Id && strcmp(ignored.SlotName, impl->slot.Title) == 0 &&
-                IsInputSlotKind(ignored.SlotKind) == IsInputSlotKind(impl->slot.Kind))
-                return false;
-        }
-
-        return true;
+        _IgnoreSlot slot{impl->Node.Id, impl->slot.Id, IsInputSlotKind(impl->slot.Kind)};
+        return !impl->IgnoreConnections.Contains(slot, impl->slot.Record->Id);
     }
 
     return false;
@@ -25,6 +25,18 @@
 
 #include <imgui.h>
 
+// Profiling hook. Define IMNODES_PROFILE_SCOPE(name) in imconfig.h or as a compile definition to report ImNodes internals
+// as zones of an external profiler. `name` is a string literal and zone lasts until the end of enclosing scope. Define
+// IMNODES_PROFILE_CHROME_TRACE instead to use bundled backend, which records zones into a Chrome trace-event JSON file.
+#if defined(IMNODES_PROFILE_CHROME_TRACE) && !defined(IMNODES_PROFILE_SCOPE)
+#   define IMNODES_PROFILE_CONCAT_(a, b) a##b
+#   define IMNODES_PROFILE_CONCAT(a, b) IMNODES_PROFILE_CONCAT_(a, b)
+#   define IMNODES_PROFILE_SCOPE(name) ImNodes::ProfileScope IMNODES_PROFILE_CONCAT(_profile_scope_, __LINE__)(name)
+#endif
+#ifndef IMNODES_PROFILE_SCOPE
+#   define IMNODES_PROFILE_SCOPE(name)
+#endif
+
 namespace ImNodes
 {
 
@@ -41,6 +53,74 @@ enum StyleColor
     ColMax
 };
 
+/// Draw layers of canvas, from back to front. Each layer is a draw channel which is set up by BeginCanvas() and merged by
+/// EndCanvas().
+enum CanvasLayer
+{
+    LayerGrid,
+    LayerCurves,
+    LayerNodeBg,
+    LayerNodeContent,
+    LayerOverlay,
+    LayerMax
+};
+
+/// Statistics of a single canvas frame, see GetCanvasStats(). Times are in milliseconds. Time spent in user code between
+/// ImNodes calls is attributed to the phase of the preceding ImNodes call.
+struct CanvasStats
+{
+    /// Number of nodes submitted with BeginNode().
+    int NodesSubmitted = 0;
+    /// Number of submitted nodes that were outside of visible canvas area.
+    int NodesCulled = 0;
+    /// Number of submitted nodes that were rendered as plain rects, see `CanvasState::Style.LodZoomThreshold`.
+    int NodesSimplified = 0;
+    /// Number of slots submitted with Begin*Slot().
+    int SlotsProcessed = 0;
+    /// Number of connections submitted with Connection() or Connections().
+    int ConnectionsSubmitted = 0;
+    /// Number of submitted connections whose curves were visible and rendered.
+    int ConnectionsDrawn = 0;
+    /// Number of rendered curves that were tessellated. Curves whose shape did not change since last frame are reused.
+    int CurvesTessellated = 0;
+    /// Number of curves whose distance to mouse cursor was computed when looking for hovered curve.
+    int CurveHitTests = 0;
+    /// Number of nodes in node cache.
+    int CachedNodes = 0;
+    /// Number of slots in slot cache.
+    int CachedSlots = 0;
+    /// Number of curves in curve cache.
+    int CachedCurves = 0;
+    /// Number of vertices emitted into window draw list between BeginCanvas() and EndCanvas(), node content included.
+    int Vertices = 0;
+    /// Number of indices emitted into window draw list between BeginCanvas() and EndCanvas(), node content included.
+    int Indices = 0;
+    /// Number of memory allocations made through ImGui allocator between BeginCanvas() and EndCanvas(), node content
+    /// included. Counted only when EnableAllocationCounter() was called. Unchanged graph should not allocate at all.
+    int Allocations = 0;
+    /// Number of bytes allocated by `Allocations`.
+    int AllocatedBytes = 0;
+    /// Time spent in BeginCanvas(), which handles canvas input and renders grid.
+    float BeginCanvasTime = 0;
+    /// Time spent rendering nodes and their slots.
+    float NodesTime = 0;
+    /// Time spent rendering connections.
+    float ConnectionsTime = 0;
+    /// Time spent in EndCanvas(), which finds hovered curve, handles selection and merges canvas layers.
+    float EndCanvasTime = 0;
+    /// Time from the start of BeginCanvas() to the end of EndCanvas().
+    float TotalTime = 0;
+    /// `true` when nodes and connections were re-emitted from redraw cache, see `CanvasState::RedrawCache`. All nodes
+    /// are reported as culled on such frames.
+    bool FromRedrawCache = false;
+};
+
+/// Job executed by a ParallelForFunc.
+typedef void (*JobFunc)(void* job_data, int job_index);
+/// Job scheduler callback. Must call `job(job_data, i)` for every `i` in range [0, job_count) and return once all jobs
+/// are finished. Jobs may run concurrently and in any order. `user_data` is `CanvasState::ParallelForUserData`.
+typedef void (*ParallelForFunc)(void* user_data, int job_count, JobFunc job, void* job_data);
+
 struct _CanvasStateImpl;
 
 struct IMGUI_API CanvasState
@@ -49,6 +129,19 @@ struct IMGUI_API CanvasState
     float Zoom = 1.0;
     /// Current scroll offset of canvas.
     ImVec2 Offset;
+    /// Opt-in redraw cache. While canvas is being panned, geometry of nodes and connections rendered on an earlier frame
+    /// is re-emitted with a translation instead of being rendered again. Node content is not submitted on such frames,
+    /// therefore it should not change while canvas is panned. Changes of node positions, selection and number of nodes or
+    /// connections are picked up on the next frame.
+    bool RedrawCache = false;
+    /// Opt-in deferred curve rendering. Connection() only records visible curves and EndCanvas() tessellates them in
+    /// parallel, using `ParallelFor` scheduler. Curves are rendered in submission order, therefore output is the same as
+    /// when curves are rendered immediately.
+    bool DeferredCurves = false;
+    /// Job scheduler used for deferred curve rendering. When null, a built-in pool of worker threads is used, unless
+    /// ImNodes is built with IMNODES_NO_THREADS in which case curves are rendered on the calling thread.
+    ParallelForFunc ParallelFor = nullptr;
+    void* ParallelForUserData = nullptr;
     /// Colors used to style elements of this canvas.
     ImColor Colors[StyleColor::ColMax];
     /// Style parameters
@@ -60,10 +153,26 @@ struct IMGUI_API CanvasState
         /// of icon (like a circle) and then no seam between icon and connection end is visible.
         float ConnectionIndent = 1.0f;
 
+        /// Spacing of minor grid lines.
         float GridSpacing = 64.0f;
+        /// Every n-th grid line is a major line. When minor lines get denser than `GridMinSpacing` they are not rendered
+        /// and major lines become minor lines of a coarser grid level. Values below 2 disable grid levels.
+        int GridMajorInterval = 4;
+        /// Minimum on-screen spacing of grid lines in pixels. Minor lines fade out as their spacing approaches this value.
+        float GridMinSpacing = 8.0f;
         float CurveStrength = 100.0f;
         float NodeRounding = 5.0f;
         ImVec2 NodeSpacing{4.0f, 4.0f};
+        /// Nodes that are further than this distance (in pixels) outside of canvas window are not rendered.
+        float CullingMargin = 32.0f;
+        /// When zoom is below this value node content is not rendered and nodes are drawn as plain rects. Set to 0 to
+        /// always render node content.
+        float LodZoomThreshold = 0.4f;
+        /// Number of segments of connection curves when zoom is below `LodZoomThreshold`. 1 renders straight lines.
+        int LodCurveSegments = 4;
+        /// When `CanvasState::RedrawCache` is enabled, nodes and connections up to this distance (in pixels) outside of
+        /// canvas window are rendered as well, so that canvas may be panned by this distance before it is rendered again.
+        float RedrawCacheMargin = 256.0f;
     } Style;
     /// Implementation detail.
     _CanvasStateImpl* _Impl = nullptr;
@@ -76,23 +185,89 @@ struct IMGUI_API CanvasState
 IMGUI_API void BeginCanvas(CanvasState* canvas);
 /// Terminate a node graph canvas that was created by calling BeginCanvas().
 IMGUI_API void EndCanvas();
-/// Begin rendering of node in a graph. Render node content when returns `true`.
+/// Begin rendering of node in a graph. Render node content when returns `true`. Returns `false` when node is outside of
+/// visible canvas area or canvas is zoomed out enough to render node as a plain rect.
 IMGUI_API bool BeginNode(void* node_id, ImVec2* pos, bool* selected);
 /// Terminates current node. Should be called regardless of BeginNode() returns value.
 IMGUI_API void EndNode();
 /// Returns `true` if the current node is hovered. Call between `BeginNode()` and `EndNode()`.
 IMGUI_API bool IsNodeHovered();
+/// Returns `true` if content of current node is not rendered because canvas is zoomed out below
+/// `CanvasState::Style.LodZoomThreshold`. Such node is drawn as a plain rect. Call between `BeginNode()` and `EndNode()`.
+IMGUI_API bool IsNodeSimplified();
 /// Specified node will be positioned at the mouse cursor on next frame. Call when new node is created.
 IMGUI_API void AutoPositionNode(void* node_id);
+//
+// Slots are identified by an ImGuiID which must be unique among input (or output) slots of a node. Functions taking a
+// slot title are thin wrappers which use `ImHashStr(title)` as slot id, therefore both kinds of functions may be mixed.
+// Slot titles are returned as `nullptr` for slots that were created with an integer id. Functions returning slot ids
+// have a `ById` suffix, so that calls passing `nullptr` for an output parameter are not ambiguous.
+//
 /// Returns `true` when new connection is made. Connection information is returned into `connection` parameter. Must be
 /// called at id scope created by BeginNode().
 IMGUI_API bool GetNewConnection(void** input_node, const char** input_slot_title, void** output_node, const char** output_slot_title);
+IMGUI_API bool GetNewConnectionById(void** input_node, ImGuiID* input_slot_id, void** output_node, ImGuiID* output_slot_id);
 /// Get information of connection that is being made and has only one end connected. Returns true when pending connection exists, false otherwise.
 IMGUI_API bool GetPendingConnection(void** node_id, const char** slot_title, int* slot_kind);
+IMGUI_API bool GetPendingConnectionById(void** node_id, ImGuiID* slot_id, int* slot_kind);
 /// Render a connection. Returns `true` when connection is present, `false` if it is deleted.
 IMGUI_API bool Connection(void* input_node, const char* input_slot, void* output_node, const char* output_slot);
+IMGUI_API bool Connection(void* input_node, ImGuiID input_slot_id, void* output_node, ImGuiID output_slot_id);
+/// Connection between two slots identified by integer slot ids. See Connections().
+struct ConnectionDesc
+{
+    /// `id` that was passed to BeginNode() of input node.
+    void* InputNode = nullptr;
+    /// Id of input slot.
+    ImGuiID InputSlot = 0;
+    /// `id` that was passed to BeginNode() of output node.
+    void* OutputNode = nullptr;
+    /// Id of output slot.
+    ImGuiID OutputSlot = 0;
+};
+/// Render an array of connections. Result is the same as calling Connection() for every element, but connections are
+/// processed in passes over the whole array: ends of all connections are looked up first, then curves are culled and
+/// their geometry is tessellated or taken from cache, and finally geometry of all visible curves is appended to the
+/// draw list together. When `out_deleted` is not null it receives `count` flags, which are `true` for connections deleted
+/// by the user. Returns number of connections deleted by the user on this call, which is the number of `true` flags
+/// written to `out_deleted`.
+IMGUI_API int Connections(const ConnectionDesc* edges, int count, bool* out_deleted = nullptr);
+/// Get connection whose curve is nearest to the mouse cursor, as determined on previous frame. Returns `false` when no
+/// curve is hovered.
+IMGUI_API bool GetHoveredConnection(void** input_node, const char** input_slot, void** output_node, const char** output_slot);
+IMGUI_API bool GetHoveredConnectionById(void** input_node, ImGuiID* input_slot_id, void** output_node, ImGuiID* output_slot_id);
+/// Directs further rendering to specified canvas layer and returns previously active layer. Node content is rendered to
+/// `LayerNodeContent`. Call between BeginCanvas() and EndCanvas().
+IMGUI_API CanvasLayer SetCanvasLayer(CanvasLayer layer);
 /// Returns active canvas state when called between BeginCanvas() and EndCanvas(). Returns nullptr otherwise. This function is not thread-safe.
 IMGUI_API CanvasState* GetCurrentCanvas();
+/// Returns statistics of the last frame of `canvas`, which are filled in by EndCanvas(). When `canvas` is null, returns
+/// statistics of the canvas that was terminated last.
+IMGUI_API const CanvasStats& GetCanvasStats(const CanvasState* canvas = nullptr);
+/// Wraps ImGui allocator functions with a counter of allocations, which are reported by GetCanvasStats(). Allocator
+/// functions that were set before this call are still used for allocating memory. Call before creating ImGui context.
+IMGUI_API void EnableAllocationCounter();
+/// Finds nodes overlapping a rect specified in canvas coordinates (same as node positions). Writes up to `max_count` node
+/// ids into `node_ids` and returns total number of nodes found. Node rects are as of previous frame.
+IMGUI_API int FindNodesInRect(const ImVec2& rect_min, const ImVec2& rect_max, void** node_ids, int max_count);
+#ifdef IMNODES_PROFILE_CHROME_TRACE
+/// Starts recording profiling zones of ImNodes. Recording is not thread-safe, zones must be entered on the thread that
+/// renders canvases.
+IMGUI_API void BeginProfileTrace();
+/// Stops recording profiling zones and writes them to `path` as Chrome trace-event JSON, which can be opened in
+/// chrome://tracing or Perfetto. Returns `false` if file could not be written.
+IMGUI_API bool EndProfileTrace(const char* path);
+/// Records a profiling zone from construction to destruction. Use IMNODES_PROFILE_SCOPE() instead.
+struct IMGUI_API ProfileScope
+{
+    const char* Name;
+    /// Start time in microseconds, negative when recording was not active.
+    double Start;
+
+    explicit ProfileScope(const char* name);
+    ~ProfileScope();
+};
+#endif
 /// Convert kind id to input type.
 inline int InputSlotKind(int kind) { return kind > 0 ? -kind : kind; }
 /// Convert kind id to output type.
@@ -103,10 +278,13 @@ inline bool IsInputSlotKind(int kind) { return kind < 0; }
 inline bool IsOutputSlotKind(int kind) { return kind > 0; }
 /// Begins slot region. Kind is unique value indicating slot type. Negative values mean input slots, positive - output slots.
 IMGUI_API bool BeginSlot(const char* title, int kind);
+IMGUI_API bool BeginSlot(ImGuiID slot_id, int kind);
 /// Begins slot region. Kind is unique value whose sign is ignored.
 inline bool BeginInputSlot(const char* title, int kind) { return BeginSlot(title, InputSlotKind(kind)); }
+inline bool BeginInputSlot(ImGuiID slot_id, int kind) { return BeginSlot(slot_id, InputSlotKind(kind)); }
 /// Begins slot region. Kind is unique value whose sign is ignored.
 inline bool BeginOutputSlot(const char* title, int kind) { return BeginSlot(title, OutputSlotKind(kind)); }
+inline bool BeginOutputSlot(ImGuiID slot_id, int kind) { return BeginSlot(slot_id, OutputSlotKind(kind)); }
 /// Rends rendering of slot. Call only if Begin*Slot() returned `true`.
 IMGUI_API void EndSlot();
 /// Returns `true` if curve connected to current slot is hovered. Call between `Begin*Slot()` and `EndSlot()`. In-progress
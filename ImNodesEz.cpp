@@ -23,6 +23,7 @@
 #   define IMGUI_DEFINE_MATH_OPERATORS
 #endif
 #include "ImNodesEz.h"
+#include "ImNodesInternal.h"
 
 #include <imgui_internal.h>
 
@@ -49,20 +50,172 @@ struct StyleColMod
     ImVec4 Value;
 };
 
+/// Node layout measured on previous frame. Widths are used for positioning columns of node on the next frame.
+struct NodeLayout
+{
+    float InputWidth = 0;
+    float ContentWidth = 0;
+    float OutputWidth = 0;
+    /// Width of the widest output slot title as of previous frame, and the one that is being measured on current frame.
+    float OutputMaxTitleWidth = 0;
+    float OutputMaxTitleWidthNext = 0;
+    /// Screen position of content and output slot columns.
+    float ContentX = 0;
+    float OutputX = 0;
+    float BodyY = 0;
+    /// Last frame on which node was submitted.
+    int LastFrame = -1;
+};
+
+/// Open addressing hash table of text sizes with linear probing, keyed by hash and length of text. Sizes are only valid
+/// for the font they were measured with, therefore table is cleared when font or font size changes, for example on zoom.
+/// Text is not stored, two different texts of equal length whose hashes collide would share the size of one of them.
+/// Entries that were not used for `MaxAge` frames are dropped when table fills up, so that titles which change every
+/// frame (for example titles displaying a value) do not grow the table without bound.
+struct TextSizeCache
+{
+    struct Entry
+    {
+        /// Hash of text, 0 for empty entries.
+        ImGuiID Hash;
+        int Length;
+        /// Last frame on which entry was used.
+        int LastFrame;
+        ImVec2 Size;
+    };
+    /// Number of frames unused entries are kept for.
+    static const int MaxAge = 60;
+    /// Table of entries, size is always zero or a power of two.
+    ImVector<Entry> Entries;
+    /// Previous table, reused by Rehash().
+    ImVector<Entry> OldEntries;
+    /// Number of non-empty entries.
+    int Count = 0;
+    /// Font and font size that cached sizes were measured with.
+    ImFont* Font = nullptr;
+    float FontSize = 0;
+
+    /// Same as ImGui::CalcTextSize(text).
+    ImVec2 CalcTextSize(const char* text)
+    {
+        ImFont* font = ImGui::GetFont();
+        float font_size = ImGui::GetFontSize();
+        if (font != Font || font_size != FontSize)
+        {
+            Clear();
+            Font = font;
+            FontSize = font_size;
+        }
+
+        int length = (int)strlen(text);
+        ImGuiID hash = ImHashStr(text, (size_t)length);
+        if (hash == 0)
+            hash = 1;
+        int frame = ImGui::GetFrameCount();
+
+        // Keep load factor under 50%.
+        if ((Count + 1) * 2 > Entries.Size)
+            Rehash(frame);
+
+        ImU32 mask = (ImU32)Entries.Size - 1;
+        for (ImU32 i = hash & mask;; i = (i + 1) & mask)
+        {
+            Entry& entry = Entries.Data[i];
+            if (entry.Hash == hash && entry.Length == length)
+            {
+                entry.LastFrame = frame;
+                return entry.Size;
+            }
+            if (entry.Hash == 0)
+            {
+                entry.Hash = hash;
+                entry.Length = length;
+                entry.LastFrame = frame;
+                entry.Size = ImGui::CalcTextSize(text, text + length);
+                Count++;
+                return entry.Size;
+            }
+        }
+    }
+
+    /// Drops entries unused for `MaxAge` frames and resizes table so that it is at most a quarter full, therefore cost of
+    /// rehashing is amortized over inserts that fill it up again.
+    void Rehash(int frame)
+    {
+        int alive_count = 0;
+        for (const Entry& entry : Entries)
+        {
+            if (entry.Hash != 0 && entry.LastFrame >= frame - MaxAge)
+                alive_count++;
+        }
+        int capacity = 64;
+        while (capacity < (alive_count + 1) * 4)
+            capacity *= 2;
+
+        // Buffer of old entries is kept for the next rehash, table of same capacity does not allocate then.
+        OldEntries.swap(Entries);
+        Entries.resize(capacity);
+        Clear();
+        ImU32 mask = (ImU32)Entries.Size - 1;
+        for (const Entry& entry : OldEntries)
+        {
+            if (entry.Hash == 0 || entry.LastFrame < frame - MaxAge)
+                continue;
+            ImU32 i = entry.Hash & mask;
+            while (Entries.Data[i].Hash != 0)
+                i = (i + 1) & mask;
+            Entries.Data[i] = entry;
+            Count++;
+        }
+    }
+
+    /// Removes all entries, keeping table memory.
+    void Clear()
+    {
+        if (!Entries.empty())
+            memset(Entries.Data, 0, Entries.size_in_bytes());
+        Count = 0;
+    }
+};
+
 struct Context
 {
     StyleVars Style;
     ImVector<StyleVarMod> StyleVarStack;
     ImVector<StyleColMod> StyleColStack;
-    ImDrawListSplitter NodeSplitter;
-    ImDrawListSplitter CanvasSplitter;
     float BodyPosY;
     bool *NodeSelected;
+    bool NodeCulled;
+    /// Layouts of nodes, keyed by hash of node id like node cache of ImNodes.
+    _HashPool<NodeLayout> Layouts;
+    /// Number of nodes submitted on current frame.
+    int NodeCount = 0;
+    /// Layout of current node. Copied from `Layouts` in BeginNode() and written back in EndNode().
+    NodeLayout Layout;
+    /// Index of current node layout in `Layouts`, -1 when node is culled.
+    int LayoutIndex = -1;
+    /// Sizes of node and slot titles.
+    TextSizeCache TextSizes;
     CanvasState State;
 };
 
 static Context *GContext = nullptr;
 
+/// Same as ImGui::TextUnformatted(), but takes text size measured by TextSizeCache instead of measuring text again.
+static void TextUnformatted(const char* text, const ImVec2& text_size)
+{
+    ImGuiWindow* window = ImGui::GetCurrentWindow();
+    if (window->SkipItems)
+        return;
+
+    ImVec2 text_pos{window->DC.CursorPos.x, window->DC.CursorPos.y + window->DC.CurrLineTextBaseOffset};
+    ImRect bb{text_pos, text_pos + text_size};
+    ImGui::ItemSize(text_size, 0.0f);
+    if (!ImGui::ItemAdd(bb, 0))
+        return;
+    ImGui::RenderText(bb.Min, text, nullptr, false);
+}
+
 
 Context* CreateContext()
 {
@@ -94,66 +247,77 @@ ImNodes::CanvasState& GetState()
 void BeginCanvas()
 {
     IM_ASSERT(GContext != nullptr);
-    Context &g = *GContext;
-    auto draw_list = ImGui::GetWindowDrawList();
-
-    //
-    // Setup and use this splitter to separate nodes and connections into layers. The connections should
-    // not be rendered until after the nodes to get correct positions in relation to the nodes' slots on
-    // the same frame, but be rendered behind the nodes.
-    //
-    g.CanvasSplitter.Clear();
-    g.CanvasSplitter.Split(draw_list, 2);
+    GContext->NodeCount = 0;
 
+    // Connections are rendered after nodes to get correct positions in relation to the nodes' slots on the same frame.
+    // Canvas layers keep them behind the nodes.
     ImNodes::BeginCanvas(&GContext->State);
 }
 
 void EndCanvas()
 {
     IM_ASSERT(GContext != nullptr);
-    Context &g = *GContext;
-    auto draw_list = ImGui::GetWindowDrawList();
+    Context& g = *GContext;
 
     ImNodes::EndCanvas();
 
-    g.CanvasSplitter.Merge(draw_list);    
+    // Layouts of nodes that were not submitted for a few frames are dropped. Like node cache of ImNodes, layouts are
+    // trimmed only when most of them are stale, so that cost of the sweep is amortized.
+    if (g.Layouts.GetAliveCount() > g.NodeCount * 2 + 64)
+    {
+        int oldest_frame = ImGui::GetFrameCount() - 3;
+        for (int i = 0; i < g.Layouts.GetSize(); i++)
+        {
+            NodeLayout* layout = g.Layouts.TryGetByIndex(i);
+            if (layout != nullptr && layout->LastFrame < oldest_frame)
+                g.Layouts.Remove(layout);
+        }
+    }
 }
 
 
 bool BeginNode(void* node_id, const char* title, ImVec2* pos, bool* selected)
 {
+    IMNODES_PROFILE_SCOPE("ImNodes::Ez::BeginNode");
     IM_ASSERT(GContext != nullptr);
     Context &g = *GContext;
-    ImGuiStorage *storage = ImGui::GetStateStorage();
-    auto draw_list = ImGui::GetWindowDrawList();
 
     g.NodeSelected = selected;
-
-    g.CanvasSplitter.SetCurrentChannel(draw_list, 1);   // Node layer.
-
-    g.NodeSplitter.Clear();
-    g.NodeSplitter.Split(draw_list, 2);
-    g.NodeSplitter.SetCurrentChannel(draw_list, 1);     // Front layer.
+    g.LayoutIndex = -1;
+    g.NodeCount++;
 
     bool result = ImNodes::BeginNode(node_id, pos, selected);
+    g.NodeCulled = !result;
+    ImGuiID layout_id = ImHashData(&node_id, sizeof(node_id));
+    int frame = ImGui::GetFrameCount();
+    if (g.NodeCulled)
+    {
+        // Node is outside of visible canvas area or it is simplified, title and slots will not be rendered. Its layout
+        // is kept for when it becomes visible again.
+        if (NodeLayout* layout = g.Layouts.GetByKey(layout_id))
+            layout->LastFrame = frame;
+        return false;
+    }
+
+    NodeLayout* layout = g.Layouts.GetOrAddByKey(layout_id);
+    layout->LastFrame = frame;
+    g.LayoutIndex = g.Layouts.GetIndex(layout);
+    g.Layout = *layout;
 
-    ImVec2 title_size = ImGui::CalcTextSize(title);
+    ImVec2 title_size = g.TextSizes.CalcTextSize(title);
     ImVec2 title_pos = ImGui::GetCursorScreenPos();
     g.BodyPosY = title_pos.y + title_size.y + g.State.Style.NodeSpacing.y * g.State.Zoom;
     ImVec2 input_pos = ImVec2{title_pos.x, g.BodyPosY + g.State.Style.NodeSpacing.y * g.State.Zoom};
 
     // Get widths from previous frame rendering.
-    float input_width = storage->GetFloat(ImGui::GetID("input-width"));
-    float content_width = storage->GetFloat(ImGui::GetID("content-width"));
-    float output_width = storage->GetFloat(ImGui::GetID("output-width"));
-    float body_width = input_width + content_width + output_width;
+    NodeLayout& l = g.Layout;
+    float body_width = l.InputWidth + l.ContentWidth + l.OutputWidth;
 
     // Ignore this the first time the node is rendered since we don't know any widths yet.
     if (body_width > 0)
     {
-        float output_max_title_width_next = storage->GetFloat(ImGui::GetID("output-max-title-width-next"));
-        storage->SetFloat(ImGui::GetID("output-max-title-width"), output_max_title_width_next);
-        storage->SetFloat(ImGui::GetID("output-max-title-width-next"), 0);
+        l.OutputMaxTitleWidth = l.OutputMaxTitleWidthNext;
+        l.OutputMaxTitleWidthNext = 0;
 
         body_width += 2*g.Style.ItemSpacing.x * g.State.Zoom;
         float body_spacing = 0;
@@ -169,15 +333,13 @@ bool BeginNode(void* node_id, const char* title, ImVec2* pos, bool* selected)
             body_spacing = ((title_size.x - body_width)*0.5f);
         }
 
-        float content_x = input_pos.x + input_width + g.Style.ItemSpacing.x * g.State.Zoom + body_spacing;
-        float output_x = content_x + content_width + g.Style.ItemSpacing.x * g.State.Zoom + body_spacing;
-        storage->SetFloat(ImGui::GetID("content-x"), content_x);
-        storage->SetFloat(ImGui::GetID("output-x"), output_x);
-        storage->SetFloat(ImGui::GetID("body-y"), input_pos.y);
+        l.ContentX = input_pos.x + l.InputWidth + g.Style.ItemSpacing.x * g.State.Zoom + body_spacing;
+        l.OutputX = l.ContentX + l.ContentWidth + g.Style.ItemSpacing.x * g.State.Zoom + body_spacing;
+        l.BodyY = input_pos.y;
     }
 
     // Render node title
-    ImGui::TextUnformatted(title);
+    TextUnformatted(title, title_size);
 
     ImGui::SetCursorScreenPos(input_pos);
 
@@ -186,11 +348,13 @@ bool BeginNode(void* node_id, const char* title, ImVec2* pos, bool* selected)
 
 void EndNode()
 {
+    IMNODES_PROFILE_SCOPE("ImNodes::Ez::EndNode");
     IM_ASSERT(GContext != nullptr);
     Context &g = *GContext;
     ImDrawList* draw_list = ImGui::GetWindowDrawList();
 
     bool hovered = IsNodeHovered();
+    bool simplified = IsNodeSimplified();
 
     // Inhibit node rendering in ImNodes::EndNode() by setting colors with alpha as 0.
     ImColor activebg = g.State.Colors[ColNodeActiveBg];
@@ -202,11 +366,27 @@ void EndNode()
 
     ImNodes::EndNode();
 
+    if (g.LayoutIndex >= 0)
+        *g.Layouts.GetByIndex(g.LayoutIndex) = g.Layout;
+
     // Restore colors.
     g.State.Colors[ColNodeActiveBg] = activebg;
     g.State.Colors[ColNodeBg] = inactivebg;
     g.State.Colors[ColNodeBorder] = border;
 
+    if (simplified)
+    {
+        // Canvas is zoomed out, node is rendered as a plain rect.
+        ImU32 node_color = GetStyleColorU32(*g.NodeSelected ? ImNodesStyleCol_NodeBodyBgActive : hovered ? ImNodesStyleCol_NodeBodyBgHovered : ImNodesStyleCol_NodeBodyBg);
+        SetCanvasLayer(LayerNodeBg);
+        draw_list->AddRectFilled(ImGui::GetItemRectMin(), ImGui::GetItemRectMax(), node_color);
+        SetCanvasLayer(LayerNodeContent);
+        return;
+    }
+
+    if (g.NodeCulled)
+        return;
+
     ImRect node_rect{
         ImGui::GetItemRectMin(),
         ImGui::GetItemRectMax()
@@ -215,7 +395,7 @@ void EndNode()
     ImVec2 titlebar_end = ImVec2{node_rect.Max.x, g.BodyPosY};
     ImVec2 body_pos = ImVec2{node_rect.Min.x, g.BodyPosY};
 
-    g.NodeSplitter.SetCurrentChannel(draw_list, 0);     // Background layer.
+    SetCanvasLayer(LayerNodeBg);
 
     // Render title bar background
     ImU32 node_color = GetStyleColorU32(*g.NodeSelected ? ImNodesStyleCol_NodeTitleBarBgActive : hovered ? ImNodesStyleCol_NodeTitleBarBgHovered : ImNodesStyleCol_NodeTitleBarBg);
@@ -229,16 +409,16 @@ void EndNode()
     draw_list->AddRect(node_rect.Min, node_rect.Max, GetStyleColorU32(ImNodesStyleCol_NodeBorder), g.State.Style.NodeRounding);
     draw_list->AddLine(body_pos, titlebar_end, GetStyleColorU32(ImNodesStyleCol_NodeBorder));
 
-    g.NodeSplitter.Merge(draw_list);
+    SetCanvasLayer(LayerNodeContent);
 }
 
 bool Slot(const char* title, int kind, ImVec2 &pos)
 {
+    IMNODES_PROFILE_SCOPE("ImNodes::Ez::Slot");
     IM_ASSERT(GContext != nullptr);
     Context &g = *GContext;
-    auto* storage = ImGui::GetStateStorage();
     const float CIRCLE_RADIUS = g.Style.SlotRadius * g.State.Zoom;
-    ImVec2 title_size = ImGui::CalcTextSize(title);
+    ImVec2 title_size = g.TextSizes.CalcTextSize(title);
     // Pull entire slot a little bit out of the edge so that curves connect into it without visible seams
     float item_offset_x = g.State.Style.NodeSpacing.x + CIRCLE_RADIUS;
     if (!ImNodes::IsOutputSlotKind(kind))
@@ -264,13 +444,13 @@ bool Slot(const char* title, int kind, ImVec2 &pos)
 
         if (ImNodes::IsOutputSlotKind(kind))
         {
-            float *max_width_next = storage->GetFloatRef(ImGui::GetID("output-max-title-width-next"));
-            *max_width_next = ImMax(*max_width_next, title_size.x);
+            g.Layout.OutputMaxTitleWidthNext = ImMax(g.Layout.OutputMaxTitleWidthNext, title_size.x);
 
-            float offset = storage->GetFloat(ImGui::GetID("output-max-title-width"), title_size.x) - title_size.x;
+            // Right-align titles of output slots. Width of widest title is not known when node is rendered first time.
+            float offset = ImMax(g.Layout.OutputMaxTitleWidth - title_size.x, 0.0f);
             ImGui::SetCursorPosX(ImGui::GetCursorPosX() + offset);
 
-            ImGui::TextUnformatted(title);
+            TextUnformatted(title, title_size);
             ImGui::SameLine(0.0f, g.Style.ItemSpacing.x);
         }
 
@@ -290,7 +470,7 @@ bool Slot(const char* title, int kind, ImVec2 &pos)
         if (ImNodes::IsInputSlotKind(kind))
         {
             ImGui::SameLine(0.0f, g.Style.ItemSpacing.x);
-            ImGui::TextUnformatted(title);
+            TextUnformatted(title, title_size);
         }
 
         ImGui::PopStyleColor();
@@ -305,9 +485,9 @@ bool Slot(const char* title, int kind, ImVec2 &pos)
 
 void InputSlots(const SlotInfo* slots, int snum)
 {
+    IMNODES_PROFILE_SCOPE("ImNodes::Ez::InputSlots");
     IM_ASSERT(GContext != nullptr);
     Context &g = *GContext;
-    ImGuiStorage *storage = ImGui::GetStateStorage();
 
     PushStyleVar(ImNodesStyleVar_ItemSpacing, g.Style.ItemSpacing * g.State.Zoom);
     PushStyleVar(ImNodesStyleVar_NodeSpacing, g.State.Style.NodeSpacing * g.State.Zoom);
@@ -323,10 +503,10 @@ void InputSlots(const SlotInfo* slots, int snum)
     }
     ImGui::EndGroup();
 
-    storage->SetFloat(ImGui::GetID("input-width"), ImGui::GetItemRectSize().x);
+    g.Layout.InputWidth = ImGui::GetItemRectSize().x;
 
     // Move cursor to the next column
-    ImGui::SetCursorScreenPos(ImVec2{storage->GetFloat(ImGui::GetID("content-x")), storage->GetFloat(ImGui::GetID("body-y"))});
+    ImGui::SetCursorScreenPos(ImVec2{g.Layout.ContentX, g.Layout.BodyY});
 
     PopStyleVar(2);
 
@@ -336,9 +516,9 @@ void InputSlots(const SlotInfo* slots, int snum)
 
 void OutputSlots(const SlotInfo* slots, int snum)
 {
+    IMNODES_PROFILE_SCOPE("ImNodes::Ez::OutputSlots");
     IM_ASSERT(GContext != nullptr);
     Context &g = *GContext;
-    ImGuiStorage *storage = ImGui::GetStateStorage();
 
     // End region of node content
     ImGui::EndGroup();
@@ -346,10 +526,10 @@ void OutputSlots(const SlotInfo* slots, int snum)
     PushStyleVar(ImNodesStyleVar_ItemSpacing, g.Style.ItemSpacing * g.State.Zoom);
     PushStyleVar(ImNodesStyleVar_NodeSpacing, g.State.Style.NodeSpacing * g.State.Zoom);
 
-    storage->SetFloat(ImGui::GetID("content-width"), ImGui::GetItemRectSize().x);
+    g.Layout.ContentWidth = ImGui::GetItemRectSize().x;
 
     // Get cursor screen position to be updated by slots as they are rendered.
-    ImVec2 pos = ImVec2{storage->GetFloat(ImGui::GetID("output-x")), storage->GetFloat(ImGui::GetID("body-y"))};
+    ImVec2 pos = ImVec2{g.Layout.OutputX, g.Layout.BodyY};
 
     // Set cursor screen position as it is recorded as the starting point in BeginGroup() for the item rect size.
     ImGui::SetCursorScreenPos(pos);
@@ -362,7 +542,7 @@ void OutputSlots(const SlotInfo* slots, int snum)
     }
     ImGui::EndGroup();
 
-    storage->SetFloat(ImGui::GetID("output-width"), ImGui::GetItemRectSize().x);
+    g.Layout.OutputWidth = ImGui::GetItemRectSize().x;
 
     PopStyleVar(2);
 }
@@ -370,11 +550,8 @@ void OutputSlots(const SlotInfo* slots, int snum)
 bool Connection(void* input_node, const char* input_slot, void* output_node, const char* output_slot)
 {
     IM_ASSERT(GContext != nullptr);
-    Context &g = *GContext;
-    auto draw_list = ImGui::GetWindowDrawList();
-
-    g.CanvasSplitter.SetCurrentChannel(draw_list, 0);   // Connection layer.
 
+    // Curves are rendered to their own canvas layer.
     return ImNodes::Connection(input_node, input_slot, output_node, output_slot);
 }
 
@@ -0,0 +1,488 @@
+//
+// Copyright (c) 2019 Rokas Kupstys.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+#ifndef IMGUI_DEFINE_MATH_OPERATORS
+#   define IMGUI_DEFINE_MATH_OPERATORS
+#endif
+#include "ImNodesGraph.h"
+
+#include <imgui_internal.h>
+#include <stdint.h>
+
+namespace ImNodes
+{
+
+/// Handles store element index in lower bits and generation in upper bits. Generation is never 0.
+static const int GraphIndexBits = 24;
+static const ImU32 GraphIndexMask = (1U << GraphIndexBits) - 1;
+/// Elements whose generation reaches this value are not reused, so that generation never wraps around.
+static const ImU8 GraphMaxGeneration = 255;
+
+GraphNodeId Graph::MakeNodeId(int index) const
+{
+    return ((ImU32)NodeGeneration[index] << GraphIndexBits) | (ImU32)index;
+}
+
+GraphEdgeId Graph::MakeEdgeId(int index) const
+{
+    return ((ImU32)EdgeGeneration[index] << GraphIndexBits) | (ImU32)index;
+}
+
+int Graph::GetNodeIndex(GraphNodeId node) const
+{
+    int index = (int)(node & GraphIndexMask);
+    if (node == 0 || index >= NodeFirstSlot.Size || NodeFirstSlot[index] < 0 ||
+        NodeGeneration[index] != (node >> GraphIndexBits))
+        return -1;
+    return index;
+}
+
+int Graph::GetEdgeIndex(GraphEdgeId edge) const
+{
+    int index = (int)(edge & GraphIndexMask);
+    if (edge == 0 || index >= EdgeOutputNode.Size || EdgeOutputNode[index] < 0 ||
+        EdgeGeneration[index] != (edge >> GraphIndexBits))
+        return -1;
+    return index;
+}
+
+GraphNodeId Graph::AddNode(const char* title, const ImVec2& pos, const Ez::SlotInfo* inputs, int input_count,
+    const Ez::SlotInfo* outputs, int output_count)
+{
+    IM_ASSERT(inputs != nullptr || input_count == 0);
+    IM_ASSERT(outputs != nullptr || output_count == 0);
+
+    int index;
+    if (!FreeNodes.empty())
+    {
+        index = FreeNodes.back();
+        FreeNodes.pop_back();
+    }
+    else
+    {
+        index = NodeFirstSlot.Size;
+        IM_ASSERT((ImU32)index <= GraphIndexMask);
+        NodeTitle.push_back(nullptr);
+        NodePos.push_back(ImVec2{});
+        NodeSelected.push_back(false);
+        NodeGeneration.push_back(1);
+        NodeFirstSlot.push_back(-1);
+        NodeInputCount.push_back(0);
+        NodeOutputCount.push_back(0);
+        NodeFirstInputEdge.push_back(-1);
+        NodeFirstOutputEdge.push_back(-1);
+        NodeInputDegree.push_back(0);
+        NodeOutputDegree.push_back(0);
+    }
+
+    NodeTitle[index] = title;
+    NodePos[index] = pos;
+    NodeSelected[index] = false;
+    NodeFirstSlot[index] = Slots.Size;
+    NodeInputCount[index] = input_count;
+    NodeOutputCount[index] = output_count;
+    NodeFirstInputEdge[index] = -1;
+    NodeFirstOutputEdge[index] = -1;
+    NodeInputDegree[index] = 0;
+    NodeOutputDegree[index] = 0;
+
+    for (int i = 0; i < input_count; i++)
+    {
+        Slots.push_back(inputs[i]);
+        SlotIds.push_back(ImHashStr(inputs[i].title));
+    }
+    for (int i = 0; i < output_count; i++)
+    {
+        Slots.push_back(outputs[i]);
+        SlotIds.push_back(ImHashStr(outputs[i].title));
+    }
+
+    NodeCount++;
+    return MakeNodeId(index);
+}
+
+void Graph::RemoveNode(GraphNodeId node)
+{
+    int index = GetNodeIndex(node);
+    if (index < 0)
+        return;
+
+    while (NodeFirstInputEdge[index] >= 0)
+        RemoveEdgeAt(NodeFirstInputEdge[index]);
+    while (NodeFirstOutputEdge[index] >= 0)
+        RemoveEdgeAt(NodeFirstOutputEdge[index]);
+
+    SlotGarbage += NodeInputCount[index] + NodeOutputCount[index];
+    NodeFirstSlot[index] = -1;
+    if (NodeGeneration[index] < GraphMaxGeneration)
+    {
+        NodeGeneration[index]++;
+        FreeNodes.push_back(index);
+    }
+    NodeCount--;
+
+    if (SlotGarbage > Slots.Size / 2)
+        CompactSlots();
+}
+
+bool Graph::IsNodeValid(GraphNodeId node) const
+{
+    return GetNodeIndex(node) >= 0;
+}
+
+GraphEdgeId Graph::AddEdge(GraphNodeId output_node, int output_slot, GraphNodeId input_node, int input_slot)
+{
+    int output_index = GetNodeIndex(output_node);
+    int input_index = GetNodeIndex(input_node);
+    if (output_index < 0 || input_index < 0)
+        return 0;
+    IM_ASSERT(output_slot >= 0 && output_slot < NodeOutputCount[output_index]);
+    IM_ASSERT(input_slot >= 0 && input_slot < NodeInputCount[input_index]);
+
+    int index;
+    if (!FreeEdges.empty())
+    {
+        index = FreeEdges.back();
+        FreeEdges.pop_back();
+    }
+    else
+    {
+        index = EdgeOutputNode.Size;
+        IM_ASSERT((ImU32)index <= GraphIndexMask);
+        EdgeOutputNode.push_back(-1);
+        EdgeOutputSlot.push_back(0);
+        EdgeInputNode.push_back(-1);
+        EdgeInputSlot.push_back(0);
+        EdgeGeneration.push_back(1);
+        EdgeNextOutput.push_back(-1);
+        EdgePrevOutput.push_back(-1);
+        EdgeNextInput.push_back(-1);
+        EdgePrevInput.push_back(-1);
+    }
+
+    EdgeOutputNode[index] = output_index;
+    EdgeOutputSlot[index] = output_slot;
+    EdgeInputNode[index] = input_index;
+    EdgeInputSlot[index] = input_slot;
+
+    // Insert at the head of edge lists of both nodes.
+    EdgePrevOutput[index] = -1;
+    EdgeNextOutput[index] = NodeFirstOutputEdge[output_index];
+    if (EdgeNextOutput[index] >= 0)
+        EdgePrevOutput[EdgeNextOutput[index]] = index;
+    NodeFirstOutputEdge[output_index] = index;
+    NodeOutputDegree[output_index]++;
+
+    EdgePrevInput[index] = -1;
+    EdgeNextInput[index] = NodeFirstInputEdge[input_index];
+    if (EdgeNextInput[index] >= 0)
+        EdgePrevInput[EdgeNextInput[index]] = index;
+    NodeFirstInputEdge[input_index] = index;
+    NodeInputDegree[input_index]++;
+
+    EdgeCount++;
+    return MakeEdgeId(index);
+}
+
+void Graph::RemoveEdge(GraphEdgeId edge)
+{
+    int index = GetEdgeIndex(edge);
+    if (index >= 0)
+        RemoveEdgeAt(index);
+}
+
+void Graph::RemoveEdgeAt(int index)
+{
+    int output_index = EdgeOutputNode[index];
+    int input_index = EdgeInputNode[index];
+
+    // Unlink from edge lists of both nodes.
+    if (EdgePrevOutput[index] >= 0)
+        EdgeNextOutput[EdgePrevOutput[index]] = EdgeNextOutput[index];
+    else
+        NodeFirstOutputEdge[output_index] = EdgeNextOutput[index];
+    if (EdgeNextOutput[index] >= 0)
+        EdgePrevOutput[EdgeNextOutput[index]] = EdgePrevOutput[index];
+    NodeOutputDegree[output_index]--;
+
+    if (EdgePrevInput[index] >= 0)
+        EdgeNextInput[EdgePrevInput[index]] = EdgeNextInput[index];
+    else
+        NodeFirstInputEdge[input_index] = EdgeNextInput[index];
+    if (EdgeNextInput[index] >= 0)
+        EdgePrevInput[EdgeNextInput[index]] = EdgePrevInput[index];
+    NodeInputDegree[input_index]--;
+
+    EdgeOutputNode[index] = -1;
+    EdgeInputNode[index] = -1;
+    if (EdgeGeneration[index] < GraphMaxGeneration)
+    {
+        EdgeGeneration[index]++;
+        FreeEdges.push_back(index);
+    }
+    EdgeCount--;
+}
+
+bool Graph::IsEdgeValid(GraphEdgeId edge) const
+{
+    return GetEdgeIndex(edge) >= 0;
+}
+
+GraphEdgeId Graph::FindEdge(GraphNodeId output_node, int output_slot, GraphNodeId input_node, int input_slot) const
+{
+    int output_index = GetNodeIndex(output_node);
+    int input_index = GetNodeIndex(input_node);
+    if (output_index < 0 || input_index < 0)
+        return 0;
+
+    for (int e = NodeFirstOutputEdge[output_index]; e >= 0; e = EdgeNextOutput[e])
+    {
+        if (EdgeOutputSlot[e] == output_slot && EdgeInputNode[e] == input_index && EdgeInputSlot[e] == input_slot)
+            return MakeEdgeId(e);
+    }
+    return 0;
+}
+
+void Graph::Clear()
+{
+    *this = Graph();
+}
+
+GraphNodeId Graph::GetNodeAt(int index) const
+{
+    if (index < 0 || index >= NodeFirstSlot.Size || NodeFirstSlot[index] < 0)
+        return 0;
+    return MakeNodeId(index);
+}
+
+const char* Graph::GetNodeTitle(GraphNodeId node) const
+{
+    int index = GetNodeIndex(node);
+    IM_ASSERT(index >= 0);
+    return NodeTitle[index];
+}
+
+ImVec2& Graph::GetNodePos(GraphNodeId node)
+{
+    int index = GetNodeIndex(node);
+    IM_ASSERT(index >= 0);
+    return NodePos[index];
+}
+
+bool& Graph::GetNodeSelected(GraphNodeId node)
+{
+    int index = GetNodeIndex(node);
+    IM_ASSERT(index >= 0);
+    return NodeSelected[index];
+}
+
+int Graph::GetInputSlotCount(GraphNodeId node) const
+{
+    int index = GetNodeIndex(node);
+    return index >= 0 ? NodeInputCount[index] : 0;
+}
+
+int Graph::GetOutputSlotCount(GraphNodeId node) const
+{
+    int index = GetNodeIndex(node);
+    return index >= 0 ? NodeOutputCount[index] : 0;
+}
+
+int Graph::GetInputDegree(GraphNodeId node) const
+{
+    int index = GetNodeIndex(node);
+    return index >= 0 ? NodeInputDegree[index] : 0;
+}
+
+int Graph::GetOutputDegree(GraphNodeId node) const
+{
+    int index = GetNodeIndex(node);
+    return index >= 0 ? NodeOutputDegree[index] : 0;
+}
+
+GraphEdgeId Graph::GetFirstInputEdge(GraphNodeId node) const
+{
+    int index = GetNodeIndex(node);
+    if (index < 0 || NodeFirstInputEdge[index] < 0)
+        return 0;
+    return MakeEdgeId(NodeFirstInputEdge[index]);
+}
+
+GraphEdgeId Graph::GetNextInputEdge(GraphEdgeId edge) const
+{
+    int index = GetEdgeIndex(edge);
+    if (index < 0 || EdgeNextInput[index] < 0)
+        return 0;
+    return MakeEdgeId(EdgeNextInput[index]);
+}
+
+GraphEdgeId Graph::GetFirstOutputEdge(GraphNodeId node) const
+{
+    int index = GetNodeIndex(node);
+    if (index < 0 || NodeFirstOutputEdge[index] < 0)
+        return 0;
+    return MakeEdgeId(NodeFirstOutputEdge[index]);
+}
+
+GraphEdgeId Graph::GetNextOutputEdge(GraphEdgeId edge) const
+{
+    int index = GetEdgeIndex(edge);
+    if (index < 0 || EdgeNextOutput[index] < 0)
+        return 0;
+    return MakeEdgeId(EdgeNextOutput[index]);
+}
+
+GraphNodeId Graph::GetEdgeOutputNode(GraphEdgeId edge) const
+{
+    int index = GetEdgeIndex(edge);
+    return index >= 0 ? MakeNodeId(EdgeOutputNode[index]) : 0;
+}
+
+int Graph::GetEdgeOutputSlot(GraphEdgeId edge) const
+{
+    int index = GetEdgeIndex(edge);
+    return index >= 0 ? EdgeOutputSlot[index] : -1;
+}
+
+GraphNodeId Graph::GetEdgeInputNode(GraphEdgeId edge) const
+{
+    int index = GetEdgeIndex(edge);
+    return index >= 0 ? MakeNodeId(EdgeInputNode[index]) : 0;
+}
+
+int Graph::GetEdgeInputSlot(GraphEdgeId edge) const
+{
+    int index = GetEdgeIndex(edge);
+    return index >= 0 ? EdgeInputSlot[index] : -1;
+}
+
+void Graph::CompactSlots()
+{
+    ImVector<Ez::SlotInfo> slots;
+    ImVector<ImGuiID> slot_ids;
+    slots.reserve(Slots.Size - SlotGarbage);
+    slot_ids.reserve(Slots.Size - SlotGarbage);
+    for (int i = 0; i < NodeFirstSlot.Size; i++)
+    {
+        int first_slot = NodeFirstSlot[i];
+        if (first_slot < 0)
+            continue;
+        NodeFirstSlot[i] = slots.Size;
+        for (int s = first_slot; s < first_slot + NodeInputCount[i] + NodeOutputCount[i]; s++)
+        {
+            slots.push_back(Slots[s]);
+            slot_ids.push_back(SlotIds[s]);
+        }
+    }
+    Slots.swap(slots);
+    SlotIds.swap(slot_ids);
+    SlotGarbage = 0;
+}
+
+/// Converts graph node handle to node id used by ImNodes.
+static void* GraphNodeToNodeId(GraphNodeId node)
+{
+    return (void*)(intptr_t)node;
+}
+
+/// Returns index of slot with specified id in a node or -1 if node has no such slot.
+static int FindGraphSlot(const Graph& graph, void* node_id, ImGuiID slot_id, bool input_slot)
+{
+    int index = graph.GetNodeIndex((GraphNodeId)(intptr_t)node_id);
+    if (index < 0)
+        return -1;
+
+    int first_slot = graph.NodeFirstSlot[index] + (input_slot ? 0 : graph.NodeInputCount[index]);
+    int count = input_slot ? graph.NodeInputCount[index] : graph.NodeOutputCount[index];
+    for (int i = 0; i < count; i++)
+    {
+        if (graph.SlotIds[first_slot + i] == slot_id)
+            return i;
+    }
+    return -1;
+}
+
+void RenderGraph(Graph& graph)
+{
+    IMNODES_PROFILE_SCOPE("ImNodes::RenderGraph");
+    for (int i = 0; i < graph.GetNodeCapacity(); i++)
+    {
+        int first_slot = graph.NodeFirstSlot[i];
+        if (first_slot < 0)
+            continue;
+
+        int input_count = graph.NodeInputCount[i];
+        if (Ez::BeginNode(GraphNodeToNodeId(graph.MakeNodeId(i)), graph.NodeTitle[i], &graph.NodePos[i], &graph.NodeSelected[i]))
+        {
+            Ez::InputSlots(graph.Slots.Data + first_slot, input_count);
+            Ez::OutputSlots(graph.Slots.Data + first_slot + input_count, graph.NodeOutputCount[i]);
+        }
+        Ez::EndNode();
+    }
+
+    // Store new connections when they are created
+    void* input_node;
+    void* output_node;
+    ImGuiID input_slot_id, output_slot_id;
+    if (GetNewConnectionById(&input_node, &input_slot_id, &output_node, &output_slot_id))
+    {
+        int input_slot = FindGraphSlot(graph, input_node, input_slot_id, true);
+        int output_slot = FindGraphSlot(graph, output_node, output_slot_id, false);
+        GraphNodeId graph_output_node = (GraphNodeId)(intptr_t)output_node;
+        GraphNodeId graph_input_node = (GraphNodeId)(intptr_t)input_node;
+        // Slots that are already connected are not connected again.
+        if (input_slot >= 0 && output_slot >= 0 &&
+            graph.FindEdge(graph_output_node, output_slot, graph_input_node, input_slot) == 0)
+            graph.AddEdge(graph_output_node, output_slot, graph_input_node, input_slot);
+    }
+
+    // Render all edges in one batch
+    graph.RenderEdges.resize(0);
+    graph.RenderEdgeIds.resize(0);
+    for (int e = 0; e < graph.EdgeOutputNode.Size; e++)
+    {
+        int output_index = graph.EdgeOutputNode[e];
+        if (output_index < 0)
+            continue;
+        int input_index = graph.EdgeInputNode[e];
+
+        ConnectionDesc edge;
+        edge.InputNode = GraphNodeToNodeId(graph.MakeNodeId(input_index));
+        edge.InputSlot = graph.SlotIds[graph.NodeFirstSlot[input_index] + graph.EdgeInputSlot[e]];
+        edge.OutputNode = GraphNodeToNodeId(graph.MakeNodeId(output_index));
+        edge.OutputSlot = graph.SlotIds[graph.NodeFirstSlot[output_index] + graph.NodeInputCount[output_index] + graph.EdgeOutputSlot[e]];
+        graph.RenderEdges.push_back(edge);
+        graph.RenderEdgeIds.push_back(graph.MakeEdgeId(e));
+    }
+
+    graph.RenderEdgeDeleted.resize(graph.RenderEdges.Size);
+    if (Connections(graph.RenderEdges.Data, graph.RenderEdges.Size, graph.RenderEdgeDeleted.Data) > 0)
+    {
+        // Remove deleted connections
+        for (int i = 0; i < graph.RenderEdgeIds.Size; i++)
+        {
+            if (graph.RenderEdgeDeleted[i])
+                graph.RemoveEdge(graph.RenderEdgeIds[i]);
+        }
+    }
+}
+
+}   // namespace ImNodes
@@ -0,0 +1,151 @@
+//
+// Copyright (c) 2019 Rokas Kupstys.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+#pragma once
+
+#include "ImNodesEz.h"
+
+namespace ImNodes
+{
+
+/// Handle of a node in a Graph. Handle consists of node index and an 8-bit generation counter, therefore handles of
+/// removed nodes do not refer to nodes that reuse their storage. Storage whose generation counter is exhausted is not
+/// reused, so that counter never wraps around. Handles obtained before Graph::Clear() may alias new nodes. 0 is never a
+/// valid handle.
+typedef ImU32 GraphNodeId;
+/// Handle of an edge in a Graph. Same rules as for GraphNodeId apply.
+typedef ImU32 GraphEdgeId;
+
+/// Optional retained graph model. Nodes, slots and edges are stored in structure-of-arrays pools. Every node keeps
+/// linked lists of its input and output edges, therefore adding and removing an edge is O(1) and removing a node is
+/// O(degree). Node and slot titles are not copied and must outlive the graph.
+struct IMGUI_API Graph
+{
+    /// Adds a node with specified input and output slots. Slots are referred to by their index in these arrays.
+    GraphNodeId AddNode(const char* title, const ImVec2& pos, const Ez::SlotInfo* inputs, int input_count,
+        const Ez::SlotInfo* outputs, int output_count);
+    /// Removes a node and all edges connected to it.
+    void RemoveNode(GraphNodeId node);
+    /// Returns `true` if node handle refers to a node in this graph.
+    bool IsNodeValid(GraphNodeId node) const;
+    /// Connects output slot of one node to input slot of another node. Does not check whether slots are already
+    /// connected, see FindEdge().
+    GraphEdgeId AddEdge(GraphNodeId output_node, int output_slot, GraphNodeId input_node, int input_slot);
+    /// Removes an edge.
+    void RemoveEdge(GraphEdgeId edge);
+    /// Returns `true` if edge handle refers to an edge in this graph.
+    bool IsEdgeValid(GraphEdgeId edge) const;
+    /// Returns edge connecting specified slots or 0 if slots are not connected. O(degree).
+    GraphEdgeId FindEdge(GraphNodeId output_node, int output_slot, GraphNodeId input_node, int input_slot) const;
+    /// Removes all nodes and edges.
+    void Clear();
+
+    /// Returns number of nodes in the graph.
+    int GetNodeCount() const { return NodeCount; }
+    /// Returns number of edges in the graph.
+    int GetEdgeCount() const { return EdgeCount; }
+    /// Returns upper bound of node indices. Use with GetNodeAt() to iterate all nodes.
+    int GetNodeCapacity() const { return NodeFirstSlot.Size; }
+    /// Returns handle of node stored at specified index or 0 if there is no node.
+    GraphNodeId GetNodeAt(int index) const;
+
+    const char* GetNodeTitle(GraphNodeId node) const;
+    ImVec2& GetNodePos(GraphNodeId node);
+    bool& GetNodeSelected(GraphNodeId node);
+    int GetInputSlotCount(GraphNodeId node) const;
+    int GetOutputSlotCount(GraphNodeId node) const;
+    /// Returns number of edges connected to input slots of a node.
+    int GetInputDegree(GraphNodeId node) const;
+    /// Returns number of edges connected to output slots of a node.
+    int GetOutputDegree(GraphNodeId node) const;
+
+    /// Iterates edges connected to input slots of a node:
+    /// for (GraphEdgeId e = graph.GetFirstInputEdge(node); e != 0; e = graph.GetNextInputEdge(e)) { ... }
+    GraphEdgeId GetFirstInputEdge(GraphNodeId node) const;
+    GraphEdgeId GetNextInputEdge(GraphEdgeId edge) const;
+    /// Iterates edges connected to output slots of a node.
+    GraphEdgeId GetFirstOutputEdge(GraphNodeId node) const;
+    GraphEdgeId GetNextOutputEdge(GraphEdgeId edge) const;
+
+    GraphNodeId GetEdgeOutputNode(GraphEdgeId edge) const;
+    int GetEdgeOutputSlot(GraphEdgeId edge) const;
+    GraphNodeId GetEdgeInputNode(GraphEdgeId edge) const;
+    int GetEdgeInputSlot(GraphEdgeId edge) const;
+
+    //
+    // Storage. Use functions above for modifying the graph.
+    //
+    /// Node data, indexed by node index. Removed nodes have `NodeFirstSlot` of -1.
+    ImVector<const char*> NodeTitle;
+    ImVector<ImVec2> NodePos;
+    ImVector<bool> NodeSelected;
+    ImVector<ImU8> NodeGeneration;
+    /// Index of first slot of a node in slot arrays. Input slots are followed by output slots.
+    ImVector<int> NodeFirstSlot;
+    ImVector<int> NodeInputCount;
+    ImVector<int> NodeOutputCount;
+    /// Heads of node edge lists, -1 when list is empty.
+    ImVector<int> NodeFirstInputEdge;
+    ImVector<int> NodeFirstOutputEdge;
+    ImVector<int> NodeInputDegree;
+    ImVector<int> NodeOutputDegree;
+    ImVector<int> FreeNodes;
+    int NodeCount = 0;
+
+    /// Slot data, indexed by slot index.
+    ImVector<Ez::SlotInfo> Slots;
+    /// Ids of slots as used by ImNodes::BeginSlot().
+    ImVector<ImGuiID> SlotIds;
+    /// Number of slot array elements owned by removed nodes. Slot arrays are compacted when they are mostly garbage.
+    int SlotGarbage = 0;
+
+    /// Edge data, indexed by edge index. Removed edges have `EdgeOutputNode` of -1.
+    ImVector<int> EdgeOutputNode;
+    ImVector<int> EdgeOutputSlot;
+    ImVector<int> EdgeInputNode;
+    ImVector<int> EdgeInputSlot;
+    ImVector<ImU8> EdgeGeneration;
+    /// Links of edge lists of output and input nodes, -1 terminates a list.
+    ImVector<int> EdgeNextOutput;
+    ImVector<int> EdgePrevOutput;
+    ImVector<int> EdgeNextInput;
+    ImVector<int> EdgePrevInput;
+    ImVector<int> FreeEdges;
+    int EdgeCount = 0;
+
+    /// Scratch buffers used by RenderGraph().
+    ImVector<ConnectionDesc> RenderEdges;
+    ImVector<GraphEdgeId> RenderEdgeIds;
+    ImVector<bool> RenderEdgeDeleted;
+
+    int GetNodeIndex(GraphNodeId node) const;
+    int GetEdgeIndex(GraphEdgeId edge) const;
+    GraphNodeId MakeNodeId(int index) const;
+    GraphEdgeId MakeEdgeId(int index) const;
+    void RemoveEdgeAt(int index);
+    void CompactSlots();
+};
+
+/// Renders nodes and edges of a graph with ImNodes::Ez. Call between Ez::BeginCanvas() and Ez::EndCanvas(). Connections
+/// made by the user are added to the graph and connections deleted by the user are removed from it.
+IMGUI_API void RenderGraph(Graph& graph);
+
+}   // namespace ImNodes
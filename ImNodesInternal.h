@@ -0,0 +1,185 @@
+//
+// Copyright (c) 2019 Rokas Kupstys.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+#pragma once
+
+#include <imgui.h>
+
+// Internal types and functions shared by ImNodes sources and benchmark. These are not part of public API and may change
+// at any time.
+
+namespace ImNodes
+{
+
+/// Pool of items keyed by ImGuiID. Unlike ImPool, keys are kept in an open addressing hash table with linear probing and
+/// removed keys are deleted from it, therefore lookups and inserts take constant time and memory does not grow when items
+/// are added and removed over time. Items keep their index until they are removed, indices of removed items are reused.
+template<typename T>
+struct _HashPool
+{
+    struct _Slot
+    {
+        /// Key of item, 0 for empty slots.
+        ImGuiID Key;
+        int Index;
+    };
+    /// Item storage. Items are relocated with memcpy when storage grows.
+    ImVector<T> Items;
+    /// Key of every item, 0 for removed items.
+    ImVector<ImGuiID> Keys;
+    /// Indices of removed items.
+    ImVector<int> FreeIndices;
+    /// Hash table of keys, size is always zero or a power of two.
+    ImVector<_Slot> Table;
+    int AliveCount = 0;
+
+    _HashPool() = default;
+    _HashPool(const _HashPool&) = delete;
+    _HashPool& operator=(const _HashPool&) = delete;
+    ~_HashPool() { Clear(); }
+
+    void Clear()
+    {
+        for (int i = 0; i < Items.Size; i++)
+        {
+            if (Keys.Data[i] != 0)
+                Items.Data[i].~T();
+        }
+        Items.clear();
+        Keys.clear();
+        FreeIndices.clear();
+        Table.clear();
+        AliveCount = 0;
+    }
+
+    T* GetByKey(ImGuiID key)
+    {
+        int slot = FindSlot(MakeKey(key));
+        return slot >= 0 ? &Items.Data[Table.Data[slot].Index] : nullptr;
+    }
+
+    T* GetOrAddByKey(ImGuiID key)
+    {
+        key = MakeKey(key);
+        int slot = FindSlot(key);
+        if (slot >= 0)
+            return &Items.Data[Table.Data[slot].Index];
+
+        // Keep load factor under 75%.
+        if ((AliveCount + 1) * 4 > Table.Size * 3)
+            Rehash(Table.Size > 0 ? Table.Size * 2 : 64);
+
+        int index;
+        if (!FreeIndices.empty())
+        {
+            index = FreeIndices.back();
+            FreeIndices.pop_back();
+        }
+        else
+        {
+            index = Items.Size;
+            Items.resize(Items.Size + 1);
+            Keys.resize(Keys.Size + 1);
+        }
+        Keys.Data[index] = key;
+        InsertSlot(key, index);
+        AliveCount++;
+        return IM_PLACEMENT_NEW(&Items.Data[index]) T();
+    }
+
+    void Remove(const T* item)
+    {
+        int index = GetIndex(item);
+        ImGuiID key = Keys.Data[index];
+        IM_ASSERT(key != 0);
+
+        // Entries following removed one are shifted back, so that probe sequences remain unbroken without tombstones.
+        ImU32 mask = (ImU32)Table.Size - 1;
+        ImU32 i = (ImU32)FindSlot(key);
+        for (ImU32 j = (i + 1) & mask; Table.Data[j].Key != 0; j = (j + 1) & mask)
+        {
+            ImU32 home = Table.Data[j].Key & mask;
+            if (((j - home) & mask) >= ((j - i) & mask))
+            {
+                Table.Data[i] = Table.Data[j];
+                i = j;
+            }
+        }
+        Table.Data[i].Key = 0;
+
+        Items.Data[index].~T();
+        Keys.Data[index] = 0;
+        FreeIndices.push_back(index);
+        AliveCount--;
+    }
+
+    T* GetByIndex(int index) { return &Items.Data[index]; }
+    int GetIndex(const T* item) const { return (int)(item - Items.Data); }
+    /// Returns item at `index`, or null if it was removed. Indices up to GetSize() are valid.
+    T* TryGetByIndex(int index) { return Keys.Data[index] != 0 ? &Items.Data[index] : nullptr; }
+    int GetSize() const { return Items.Size; }
+    int GetAliveCount() const { return AliveCount; }
+
+    /// Key 0 marks empty slots, it is replaced by another key.
+    static ImGuiID MakeKey(ImGuiID key) { return key != 0 ? key : 1; }
+
+    int FindSlot(ImGuiID key) const
+    {
+        if (Table.Size == 0)
+            return -1;
+        ImU32 mask = (ImU32)Table.Size - 1;
+        for (ImU32 i = key & mask;; i = (i + 1) & mask)
+        {
+            if (Table.Data[i].Key == key)
+                return (int)i;
+            if (Table.Data[i].Key == 0)
+                return -1;
+        }
+    }
+
+    void InsertSlot(ImGuiID key, int index)
+    {
+        ImU32 mask = (ImU32)Table.Size - 1;
+        ImU32 i = key & mask;
+        while (Table.Data[i].Key != 0)
+            i = (i + 1) & mask;
+        Table.Data[i].Key = key;
+        Table.Data[i].Index = index;
+    }
+
+    void Rehash(int capacity)
+    {
+        Table.resize(capacity);
+        memset((void*)Table.Data, 0, Table.size_in_bytes());
+        for (int i = 0; i < Keys.Size; i++)
+        {
+            if (Keys.Data[i] != 0)
+                InsertSlot(Keys.Data[i], i);
+        }
+    }
+};
+
+/// Evaluates `num_segments + 1` points of cubic bezier curve `p` at uniformly spaced parameters into `out`.
+void BezierCubicTessellate(const ImVec2* p, int num_segments, ImVec2* out);
+/// Returns squared distance from `point` to polyline made of `count` points.
+float PolylineDistanceSqr(const ImVec2* points, int count, const ImVec2& point);
+
+}   // namespace ImNodes
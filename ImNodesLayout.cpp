@@ -0,0 +1,563 @@
+//
+// Copyright (c) 2019 Rokas Kupstys.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+#include "ImNodesLayout.h"
+
+#include <algorithm>
+#include <climits>
+#include <vector>
+
+// Memory is allocated with std::vector instead of ImGui allocator, because layout may be computed on a thread other
+// than the one that renders ImGui.
+
+namespace ImNodes
+{
+
+namespace Layout
+{
+
+/// Connection in direction of data flow. Reversed connections of cycles and connection segments between dummy nodes
+/// are links as well.
+struct _Link
+{
+    int From;
+    int To;
+};
+
+/// Adjacency lists in compressed form. Neighbours of node `v` are stored in `Links[Start[v]..Start[v + 1])` as indices
+/// of links.
+struct _Adjacency
+{
+    std::vector<int> Start;
+    std::vector<int> Links;
+
+    /// Builds lists of outgoing links, or of incoming links when `incoming` is set.
+    void Build(int node_count, const std::vector<_Link>& links, bool incoming)
+    {
+        Start.assign(node_count + 1, 0);
+        for (const _Link& link : links)
+            Start[(incoming ? link.To : link.From) + 1]++;
+        for (int i = 0; i < node_count; i++)
+            Start[i + 1] += Start[i];
+
+        Links.resize(links.size());
+        std::vector<int> cursor(Start.begin(), Start.end() - 1);
+        for (int i = 0; i < (int)links.size(); i++)
+            Links[cursor[incoming ? links[i].To : links[i].From]++] = i;
+    }
+
+    int Count(int node) const { return Start[node + 1] - Start[node]; }
+};
+
+/// Reverses links which close cycles. Nodes are put into a sequence by greedy heuristic of Eades, Lin and Smyth: sinks
+/// are moved to the end of the sequence and sources to its start, when there are neither, node with the largest
+/// difference of outgoing and incoming links is moved to the start. Links pointing backwards in the sequence are reversed,
+/// which makes graph acyclic. Unlike reversing back edges of depth-first search, reversed links follow global order of
+/// nodes, therefore they do not create long paths which would stretch layering.
+static void BreakCycles(int node_count, const _Adjacency& out, const _Adjacency& in, std::vector<_Link>& links)
+{
+    // Nodes which are not removed yet are kept in buckets: sinks, sources and others by difference of their outgoing and
+    // incoming link counts. Buckets are doubly linked lists.
+    std::vector<int> out_count(node_count), in_count(node_count);
+    int max_degree = 0;
+    for (int v = 0; v < node_count; v++)
+    {
+        out_count[v] = out.Count(v);
+        in_count[v] = in.Count(v);
+        max_degree = std::max(max_degree, std::max(out_count[v], in_count[v]));
+    }
+    const int sinks = 0;
+    const int sources = 1;
+    const int first_delta = 2 + max_degree;
+    std::vector<int> head(first_delta + max_degree + 1, -1);
+    std::vector<int> next(node_count), prev(node_count), bucket(node_count);
+    auto get_bucket = [&](int v)
+    {
+        if (out_count[v] == 0)
+            return sinks;
+        if (in_count[v] == 0)
+            return sources;
+        return first_delta + out_count[v] - in_count[v];
+    };
+    auto insert = [&](int v)
+    {
+        int b = get_bucket(v);
+        bucket[v] = b;
+        prev[v] = -1;
+        next[v] = head[b];
+        if (head[b] >= 0)
+            prev[head[b]] = v;
+        head[b] = v;
+        return b;
+    };
+    auto unlink = [&](int v)
+    {
+        if (prev[v] >= 0)
+            next[prev[v]] = next[v];
+        else
+            head[bucket[v]] = next[v];
+        if (next[v] >= 0)
+            prev[next[v]] = prev[v];
+    };
+
+    int max_bucket = first_delta;
+    for (int v = 0; v < node_count; v++)
+        max_bucket = std::max(max_bucket, insert(v));
+
+    // Position of every node in the sequence. Nodes moved to the start get increasing positions, nodes moved to the end
+    // get decreasing negative positions, which sort after all of the positive ones.
+    std::vector<int> position(node_count);
+    std::vector<bool> removed(node_count, false);
+    int start_position = 0;
+    int end_position = -1;
+    for (int remaining = node_count; remaining > 0; remaining--)
+    {
+        int v;
+        if (head[sinks] >= 0)
+        {
+            v = head[sinks];
+            position[v] = end_position--;
+        }
+        else
+        {
+            if (head[sources] >= 0)
+                v = head[sources];
+            else
+            {
+                while (head[max_bucket] < 0)
+                    max_bucket--;
+                v = head[max_bucket];
+            }
+            position[v] = start_position++;
+        }
+        unlink(v);
+        removed[v] = true;
+
+        // Neighbours lose a link and move to other buckets.
+        for (int j = in.Start[v]; j < in.Start[v + 1]; j++)
+        {
+            int w = links[in.Links[j]].From;
+            if (removed[w])
+                continue;
+            unlink(w);
+            out_count[w]--;
+            insert(w);
+        }
+        for (int j = out.Start[v]; j < out.Start[v + 1]; j++)
+        {
+            int w = links[out.Links[j]].To;
+            if (removed[w])
+                continue;
+            unlink(w);
+            in_count[w]--;
+            max_bucket = std::max(max_bucket, insert(w));
+        }
+    }
+
+    for (int v = 0; v < node_count; v++)
+    {
+        if (position[v] < 0)
+            position[v] += node_count + 1;
+    }
+    for (_Link& link : links)
+    {
+        if (position[link.From] > position[link.To])
+            std::swap(link.From, link.To);
+    }
+}
+
+/// Assigns nodes of acyclic graph to layers. Every node is placed to the right of all its predecessors (longest path
+/// layering), then nodes with at least as many outgoing as incoming links are pulled right towards their successors,
+/// which shortens connections of source nodes.
+static int AssignLayers(int node_count, const std::vector<_Link>& links, std::vector<int>& layer)
+{
+    _Adjacency out, in;
+    out.Build(node_count, links, false);
+    in.Build(node_count, links, true);
+
+    // Topological order by Kahn's algorithm.
+    std::vector<int> order;
+    order.reserve(node_count);
+    std::vector<int> in_degree(node_count);
+    for (int v = 0; v < node_count; v++)
+    {
+        in_degree[v] = in.Count(v);
+        if (in_degree[v] == 0)
+            order.push_back(v);
+    }
+    layer.assign(node_count, 0);
+    for (int i = 0; i < (int)order.size(); i++)
+    {
+        int v = order[i];
+        for (int j = out.Start[v]; j < out.Start[v + 1]; j++)
+        {
+            int w = links[out.Links[j]].To;
+            layer[w] = std::max(layer[w], layer[v] + 1);
+            if (--in_degree[w] == 0)
+                order.push_back(w);
+        }
+    }
+    IM_ASSERT((int)order.size() == node_count);
+
+    for (int i = node_count - 1; i >= 0; i--)
+    {
+        int v = order[i];
+        int out_count = out.Count(v);
+        if (out_count == 0 || out_count < in.Count(v))
+            continue;
+        int min_layer = INT_MAX;
+        for (int j = out.Start[v]; j < out.Start[v + 1]; j++)
+            min_layer = std::min(min_layer, layer[links[out.Links[j]].To]);
+        layer[v] = min_layer - 1;
+    }
+
+    int layer_count = 0;
+    for (int v = 0; v < node_count; v++)
+        layer_count = std::max(layer_count, layer[v] + 1);
+    return layer_count;
+}
+
+/// Fenwick tree of counts, used for counting crossings.
+struct _CountTree
+{
+    std::vector<int> Counts;
+
+    void Reset(int size) { Counts.assign(size + 1, 0); }
+
+    void Add(int index)
+    {
+        for (int i = index + 1; i < (int)Counts.size(); i += i & -i)
+            Counts[i]++;
+    }
+
+    /// Returns number of added indices which are less than or equal to `index`.
+    int CountUpTo(int index) const
+    {
+        int count = 0;
+        for (int i = index + 1; i > 0; i -= i & -i)
+            count += Counts[i];
+        return count;
+    }
+};
+
+/// Layered graph where every link connects nodes of adjacent layers.
+struct _LayeredGraph
+{
+    /// Layer of every node.
+    std::vector<int> Layer;
+    /// Nodes of every layer, in vertical order.
+    std::vector<std::vector<int>> Layers;
+    /// Index of every node in its layer.
+    std::vector<int> Order;
+    std::vector<_Link> Links;
+    _Adjacency Out;
+    _Adjacency In;
+    /// Scratch buffers.
+    std::vector<float> Keys;
+    std::vector<int> Targets;
+    _CountTree Tree;
+
+    /// Number of crossings of links between layer `l` and `l + 1`. Links are enumerated in order of their source nodes,
+    /// crossings are inversions in resulting sequence of target positions.
+    ImS64 CountCrossings(int l)
+    {
+        Tree.Reset((int)Layers[l + 1].size());
+        ImS64 crossings = 0;
+        int added = 0;
+        for (int v : Layers[l])
+        {
+            Targets.clear();
+            for (int j = Out.Start[v]; j < Out.Start[v + 1]; j++)
+                Targets.push_back(Order[Links[Out.Links[j]].To]);
+            std::sort(Targets.begin(), Targets.end());
+            for (int target : Targets)
+            {
+                crossings += added - Tree.CountUpTo(target);
+                Tree.Add(target);
+                added++;
+            }
+        }
+        return crossings;
+    }
+
+    ImS64 CountCrossings()
+    {
+        ImS64 crossings = 0;
+        for (int l = 0; l + 1 < (int)Layers.size(); l++)
+            crossings += CountCrossings(l);
+        return crossings;
+    }
+
+    /// Sorts layer `l` by average position of neighbours in previous layer, or in next layer when `backward` is set.
+    /// Nodes without such neighbours keep their position.
+    void SortByBarycenter(int l, bool backward)
+    {
+        const _Adjacency& adjacency = backward ? Out : In;
+        std::vector<int>& layer = Layers[l];
+        for (int v : layer)
+        {
+            int count = adjacency.Count(v);
+            if (count == 0)
+            {
+                Keys[v] = (float)Order[v];
+                continue;
+            }
+            float sum = 0.0f;
+            for (int j = adjacency.Start[v]; j < adjacency.Start[v + 1]; j++)
+            {
+                const _Link& link = Links[adjacency.Links[j]];
+                sum += (float)Order[backward ? link.To : link.From];
+            }
+            Keys[v] = sum / (float)count;
+        }
+        // Ties keep current order, so that result is deterministic.
+        std::sort(layer.begin(), layer.end(), [this](int a, int b)
+        {
+            return Keys[a] < Keys[b] || (Keys[a] == Keys[b] && Order[a] < Order[b]);
+        });
+        for (int i = 0; i < (int)layer.size(); i++)
+            Order[layer[i]] = i;
+    }
+};
+
+/// Places nodes of a layer as close to `desired` centers as possible while keeping their order and minimal distance
+/// `gaps[i]` between centers of nodes `i - 1` and `i`. Subtracting accumulated gaps turns this into isotonic regression,
+/// which is solved by pool adjacent violators algorithm.
+static void PlaceLayer(const std::vector<float>& desired, const std::vector<float>& gaps, std::vector<float>& out_centers,
+    std::vector<float>& block_value, std::vector<int>& block_size)
+{
+    int count = (int)desired.size();
+    block_value.clear();
+    block_size.clear();
+    float offset = 0.0f;
+    for (int i = 0; i < count; i++)
+    {
+        offset += gaps[i];
+        block_value.push_back(desired[i] - offset);
+        block_size.push_back(1);
+        while (block_value.size() > 1 && block_value[block_value.size() - 2] > block_value.back())
+        {
+            int size = block_size.back();
+            float value = block_value.back();
+            block_value.pop_back();
+            block_size.pop_back();
+            int prev_size = block_size.back();
+            block_value.back() = (block_value.back() * (float)prev_size + value * (float)size) / (float)(prev_size + size);
+            block_size.back() += size;
+        }
+    }
+
+    out_centers.resize(count);
+    offset = 0.0f;
+    int i = 0;
+    for (int b = 0; b < (int)block_value.size(); b++)
+    {
+        for (int j = 0; j < block_size[b]; j++, i++)
+        {
+            offset += gaps[i];
+            out_centers[i] = block_value[b] + offset;
+        }
+    }
+}
+
+void Compute(const ImVec2* node_sizes, int node_count, const Edge* edges, int edge_count, ImVec2* out_positions,
+    const Config& config)
+{
+    IM_ASSERT(node_count >= 0 && edge_count >= 0);
+    IM_ASSERT(node_sizes != nullptr || node_count == 0);
+    IM_ASSERT(out_positions != nullptr || node_count == 0);
+    IM_ASSERT(edges != nullptr || edge_count == 0);
+    if (node_count == 0)
+        return;
+
+    // Self-loops do not affect layout.
+    std::vector<_Link> links;
+    links.reserve(edge_count);
+    for (int i = 0; i < edge_count; i++)
+    {
+        IM_ASSERT(edges[i].OutputNode >= 0 && edges[i].OutputNode < node_count);
+        IM_ASSERT(edges[i].InputNode >= 0 && edges[i].InputNode < node_count);
+        if (edges[i].OutputNode != edges[i].InputNode)
+            links.push_back({edges[i].OutputNode, edges[i].InputNode});
+    }
+
+    {
+        _Adjacency out, in;
+        out.Build(node_count, links, false);
+        in.Build(node_count, links, true);
+        BreakCycles(node_count, out, in, links);
+    }
+
+    _LayeredGraph graph;
+    int layer_count = AssignLayers(node_count, links, graph.Layer);
+
+    // Links spanning multiple layers are split into chains of dummy nodes, so that every link connects adjacent layers.
+    // Shortest links are split first, links that would exceed limit of dummy nodes are left out of crossing minimization
+    // and coordinate placement.
+    int max_span = 1;
+    {
+        std::vector<int> span_links(layer_count + 1, 0);
+        for (const _Link& link : links)
+            span_links[graph.Layer[link.To] - graph.Layer[link.From]]++;
+        ImS64 max_dummy_count = (ImS64)std::max(config.MaxDummyNodesPerEdge, 0) * (ImS64)links.size();
+        ImS64 dummy_count = 0;
+        for (int span = 2; span <= layer_count; span++)
+        {
+            dummy_count += (ImS64)span_links[span] * (span - 1);
+            if (dummy_count > max_dummy_count)
+                break;
+            max_span = span;
+        }
+    }
+    int total_count = node_count;
+    graph.Links.reserve(links.size());
+    for (const _Link& link : links)
+    {
+        if (graph.Layer[link.To] - graph.Layer[link.From] > max_span)
+            continue;
+        int from = link.From;
+        for (int l = graph.Layer[link.From] + 1; l < graph.Layer[link.To]; l++)
+        {
+            graph.Layer.push_back(l);
+            graph.Links.push_back({from, total_count});
+            from = total_count++;
+        }
+        graph.Links.push_back({from, link.To});
+    }
+    graph.Out.Build(total_count, graph.Links, false);
+    graph.In.Build(total_count, graph.Links, true);
+
+    graph.Layers.resize(layer_count);
+    graph.Order.resize(total_count);
+    graph.Keys.resize(total_count);
+    for (int v = 0; v < total_count; v++)
+    {
+        std::vector<int>& layer = graph.Layers[graph.Layer[v]];
+        graph.Order[v] = (int)layer.size();
+        layer.push_back(v);
+    }
+
+    // Crossing minimization. Layers are swept forward and backward, best ordering found is kept.
+    ImS64 best_crossings = graph.CountCrossings();
+    std::vector<int> best_order = graph.Order;
+    for (int iteration = 0; iteration < config.CrossingIterations && best_crossings > 0; iteration++)
+    {
+        for (int l = 1; l < layer_count; l++)
+            graph.SortByBarycenter(l, false);
+        for (int l = layer_count - 2; l >= 0; l--)
+            graph.SortByBarycenter(l, true);
+
+        ImS64 crossings = graph.CountCrossings();
+        if (crossings < best_crossings)
+        {
+            best_crossings = crossings;
+            best_order = graph.Order;
+        }
+    }
+    graph.Order.swap(best_order);
+    for (std::vector<int>& layer : graph.Layers)
+    {
+        graph.Targets.assign(layer.begin(), layer.end());
+        for (int v : graph.Targets)
+            layer[graph.Order[v]] = v;
+    }
+
+    // Layers become columns. Dummy nodes have no size.
+    auto get_size = [&](int v) { return v < node_count ? node_sizes[v] : ImVec2{0.0f, 0.0f}; };
+    std::vector<float> layer_x(layer_count, 0.0f);
+    {
+        float x = 0.0f;
+        for (int l = 0; l < layer_count; l++)
+        {
+            float width = 0.0f;
+            for (int v : graph.Layers[l])
+                width = std::max(width, get_size(v).x);
+            layer_x[l] = x;
+            x += width + config.LayerSpacing;
+        }
+    }
+
+    // Vertical coordinates. Nodes are stacked first, then repeatedly moved towards average center of their neighbours in
+    // previous layer (or next layer on backward sweeps) while preserving order and spacing.
+    std::vector<float> centers(total_count);
+    std::vector<std::vector<float>> gaps(layer_count);
+    for (int l = 0; l < layer_count; l++)
+    {
+        const std::vector<int>& layer = graph.Layers[l];
+        gaps[l].resize(layer.size());
+        float prev_half_height = 0.0f;
+        float y = 0.0f;
+        for (int i = 0; i < (int)layer.size(); i++)
+        {
+            float half_height = get_size(layer[i]).y * 0.5f;
+            gaps[l][i] = i == 0 ? 0.0f : prev_half_height + half_height + config.NodeSpacing;
+            y += gaps[l][i];
+            centers[layer[i]] = y;
+            prev_half_height = half_height;
+        }
+    }
+
+    std::vector<float> desired, placed, block_value;
+    std::vector<int> block_size;
+    auto place = [&](int l, bool backward)
+    {
+        const _Adjacency& adjacency = backward ? graph.Out : graph.In;
+        const std::vector<int>& layer = graph.Layers[l];
+        desired.resize(layer.size());
+        for (int i = 0; i < (int)layer.size(); i++)
+        {
+            int v = layer[i];
+            int count = adjacency.Count(v);
+            if (count == 0)
+            {
+                desired[i] = centers[v];
+                continue;
+            }
+            float sum = 0.0f;
+            for (int j = adjacency.Start[v]; j < adjacency.Start[v + 1]; j++)
+            {
+                const _Link& link = graph.Links[adjacency.Links[j]];
+                sum += centers[backward ? link.To : link.From];
+            }
+            desired[i] = sum / (float)count;
+        }
+        PlaceLayer(desired, gaps[l], placed, block_value, block_size);
+        for (int i = 0; i < (int)layer.size(); i++)
+            centers[layer[i]] = placed[i];
+    };
+    for (int iteration = 0; iteration < config.CoordinateIterations; iteration++)
+    {
+        for (int l = 1; l < layer_count; l++)
+            place(l, false);
+        for (int l = layer_count - 2; l >= 0; l--)
+            place(l, true);
+    }
+
+    float min_y = FLT_MAX;
+    for (int v = 0; v < node_count; v++)
+        min_y = std::min(min_y, centers[v] - node_sizes[v].y * 0.5f);
+    for (int v = 0; v < node_count; v++)
+        out_positions[v] = ImVec2{layer_x[graph.Layer[v]], centers[v] - node_sizes[v].y * 0.5f - min_y};
+}
+
+}   // namespace Layout
+
+}   // namespace ImNodes
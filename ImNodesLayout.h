@@ -0,0 +1,66 @@
+//
+// Copyright (c) 2019 Rokas Kupstys.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+#pragma once
+
+#include <imgui.h>
+
+namespace ImNodes
+{
+
+namespace Layout
+{
+
+/// Connection between two nodes, which are referred to by their index. Data flows from the output node on the left to
+/// the input node on the right.
+struct Edge
+{
+    int OutputNode = 0;
+    int InputNode = 0;
+};
+
+struct Config
+{
+    /// Horizontal distance between layers (columns) of nodes.
+    float LayerSpacing = 64.0f;
+    /// Vertical distance between nodes of a layer.
+    float NodeSpacing = 16.0f;
+    /// Connections spanning several layers are split into chains of invisible dummy nodes, which keep nodes of crossed
+    /// layers out of the way of connection. Number of dummy nodes is limited to this value times number of connections.
+    /// Once limit is reached, longer connections are not split and do not affect order and placement of nodes.
+    int MaxDummyNodesPerEdge = 4;
+    /// Maximum number of barycenter sweeps which reorder nodes in layers to reduce number of crossing connections.
+    int CrossingIterations = 8;
+    /// Number of sweeps which move nodes vertically to straighten connections.
+    int CoordinateIterations = 8;
+};
+
+/// Computes a layered left-to-right layout of a graph and writes position of top-left corner of every node into
+/// `out_positions`, in canvas coordinates with the top-left corner of the graph at 0,0. Cycles are broken by treating
+/// some connections as reversed, nodes are assigned to layers, layers are reordered to reduce crossings of connections
+/// and nodes are moved vertically to straighten connections. Does not use ImGui context, therefore it may be called
+/// from any thread.
+IMGUI_API void Compute(const ImVec2* node_sizes, int node_count, const Edge* edges, int edge_count,
+    ImVec2* out_positions, const Config& config = Config());
+
+}   // namespace Layout
+
+}   // namespace ImNodes
@@ -0,0 +1,535 @@
+//
+// Copyright (c) 2019 Rokas Kupstys.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+// Headless benchmark of ImNodes. Renders synthetic graphs with no rendering backend while scripted input pans, zooms,
+// drags a node and box-selects, and reports CPU time, draw data size and allocations per frame. Exits with an error when
+// ImNodes allocates memory while an unchanged graph is rendered.
+//
+// Usage: ImNodesBench [max_nodes] [frames_per_phase]
+
+#ifndef IMGUI_DEFINE_MATH_OPERATORS
+#   define IMGUI_DEFINE_MATH_OPERATORS
+#endif
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+#include <imgui.h>
+#include <imgui_internal.h>
+#include "ImNodesEz.h"
+#include "ImNodesGraph.h"
+#include "ImNodesInternal.h"
+#include "ImNodesLayout.h"
+
+typedef std::chrono::steady_clock Clock;
+
+static double ElapsedMs(Clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+/// Counts allocations made through ImGui allocator, which ImNodes uses as well.
+struct AllocationCounter
+{
+    size_t Count = 0;
+    size_t Bytes = 0;
+};
+
+static void* CountingAlloc(size_t size, void* user_data)
+{
+    auto* counter = (AllocationCounter*)user_data;
+    counter->Count++;
+    counter->Bytes += size;
+    return malloc(size);
+}
+
+static void CountingFree(void* ptr, void* user_data)
+{
+    IM_UNUSED(user_data);
+    free(ptr);
+}
+
+/// Xorshift generator. Every run benchmarks the same graphs.
+struct Random
+{
+    ImU32 State;
+
+    explicit Random(ImU32 seed) : State(seed) { }
+
+    ImU32 Next()
+    {
+        State ^= State << 13;
+        State ^= State >> 17;
+        State ^= State << 5;
+        return State;
+    }
+
+    int Range(int min, int max) { return min + (int)(Next() % (ImU32)(max - min + 1)); }
+    float Range(float min, float max) { return min + (max - min) * (float)(Next() & 0xFFFFFF) / (float)0xFFFFFF; }
+};
+
+enum NodeSlotTypes
+{
+    NodeSlotFloat = 1,   // ID can not be 0
+    NodeSlotVector,
+    NodeSlotMatrix,
+    NodeSlotTexture,
+};
+
+static const ImNodes::Ez::SlotInfo bench_slots[] = {
+    {"Float", NodeSlotFloat}, {"Vector", NodeSlotVector}, {"Matrix", NodeSlotMatrix}, {"Texture", NodeSlotTexture}
+};
+static const int max_slots = IM_ARRAYSIZE(bench_slots);
+
+/// Nodes are laid out in a grid. Every node has 1-4 input and output slots and up to `max_fan_out` outgoing edges to
+/// nodes nearby, which is similar to what real graphs look like.
+static void GenerateGraph(ImNodes::Graph& graph, int node_count, int max_fan_out, ImU32 seed)
+{
+    Random rng(seed);
+    int columns = ImMax((int)sqrtf((float)node_count), 1);
+    std::vector<ImNodes::GraphNodeId> nodes;
+    nodes.reserve(node_count);
+    for (int i = 0; i < node_count; i++)
+    {
+        ImVec2 pos{50.0f + (i % columns) * 220.0f, 50.0f + (i / columns) * 160.0f};
+        nodes.push_back(graph.AddNode("Node", pos, bench_slots, rng.Range(1, max_slots), bench_slots, rng.Range(1, max_slots)));
+    }
+    for (int i = 0; i < node_count; i++)
+    {
+        int fan_out = rng.Range(0, max_fan_out);
+        for (int e = 0; e < fan_out; e++)
+        {
+            int target = i + 1 + rng.Range(0, columns);
+            if (target >= node_count)
+                break;
+            int output_slot = rng.Range(0, graph.GetOutputSlotCount(nodes[i]) - 1);
+            int input_slot = rng.Range(0, graph.GetInputSlotCount(nodes[target]) - 1);
+            graph.AddEdge(nodes[i], output_slot, nodes[target], input_slot);
+        }
+    }
+}
+
+enum BenchApi
+{
+    BenchApiCore,
+    /// Core API with CanvasState::RedrawCache enabled.
+    BenchApiCoreCached,
+    /// Core API with CanvasState::DeferredCurves enabled.
+    BenchApiCoreDeferred,
+    BenchApiEz,
+    BenchApiMax
+};
+
+static const char* const api_names[BenchApiMax] = {"core", "core-cached", "core-deferred", "ez"};
+
+enum BenchPhase
+{
+    BenchPhaseIdle,
+    BenchPhasePan,
+    BenchPhaseZoom,
+    BenchPhaseDrag,
+    BenchPhaseBoxSelect,
+    BenchPhaseMax
+};
+
+static const char* const phase_names[BenchPhaseMax] = {"idle", "pan", "zoom", "drag", "box-select"};
+static const ImVec2 display_size{1920.0f, 1080.0f};
+
+/// Sets up mouse and keyboard state for `frame` of a phase. The last frame of a phase releases all buttons.
+static void ScriptInput(ImGuiIO& io, BenchPhase phase, int frame, int frames)
+{
+    bool last = frame == frames - 1;
+    float t = (float)frame;
+    io.MousePos = display_size * 0.5f;
+    io.MouseWheel = 0.0f;
+    io.KeyCtrl = false;
+    for (bool& down : io.MouseDown)
+        down = false;
+
+    switch (phase)
+    {
+    case BenchPhaseIdle:
+        break;
+    case BenchPhasePan:
+        io.MouseDown[2] = !last;
+        io.MousePos -= ImVec2{8.0f, 4.0f} * t;
+        break;
+    case BenchPhaseZoom:
+        // Zoom out to level of detail mode and back.
+        io.KeyCtrl = true;
+        io.MouseWheel = frame < frames / 2 ? -1.0f : 1.0f;
+        break;
+    case BenchPhaseDrag:
+        // Grab title of the first node.
+        io.MouseDown[0] = !last;
+        io.MousePos = ImVec2{60.0f, 56.0f} + ImVec2{4.0f, 2.0f} * t;
+        break;
+    case BenchPhaseBoxSelect:
+        // Start in empty canvas area above the first node.
+        io.MouseDown[0] = !last;
+        io.MousePos = ImVec2{20.0f, 20.0f} + ImVec2{24.0f, 14.0f} * t;
+        break;
+    default:
+        IM_ASSERT(0);
+    }
+}
+
+/// Renders graph with core API, as an application with its own node storage would.
+static void RenderCoreGraph(ImNodes::Graph& graph, std::vector<ImNodes::ConnectionDesc>& edges)
+{
+    for (int i = 0; i < graph.GetNodeCapacity(); i++)
+    {
+        int first_slot = graph.NodeFirstSlot[i];
+        if (first_slot < 0)
+            continue;
+
+        if (ImNodes::BeginNode((void*)(intptr_t)graph.MakeNodeId(i), &graph.NodePos[i], &graph.NodeSelected[i]))
+        {
+            ImGui::TextUnformatted(graph.NodeTitle[i]);
+            int input_count = graph.NodeInputCount[i];
+            for (int s = first_slot; s < first_slot + input_count; s++)
+            {
+                if (ImNodes::BeginInputSlot(graph.SlotIds[s], graph.Slots[s].kind))
+                {
+                    ImGui::TextUnformatted(graph.Slots[s].title);
+                    ImNodes::EndSlot();
+                }
+            }
+            for (int s = first_slot + input_count; s < first_slot + input_count + graph.NodeOutputCount[i]; s++)
+            {
+                if (ImNodes::BeginOutputSlot(graph.SlotIds[s], graph.Slots[s].kind))
+                {
+                    ImGui::TextUnformatted(graph.Slots[s].title);
+                    ImNodes::EndSlot();
+                }
+            }
+        }
+        ImNodes::EndNode();
+    }
+
+    // Scripted input never changes connections, therefore edge list is built once.
+    if (edges.empty())
+    {
+        edges.reserve(graph.GetEdgeCount());
+        for (int e = 0; e < graph.EdgeOutputNode.Size; e++)
+        {
+            int output_index = graph.EdgeOutputNode[e];
+            if (output_index < 0)
+                continue;
+            int input_index = graph.EdgeInputNode[e];
+            ImNodes::ConnectionDesc edge;
+            edge.InputNode = (void*)(intptr_t)graph.MakeNodeId(input_index);
+            edge.InputSlot = graph.SlotIds[graph.NodeFirstSlot[input_index] + graph.EdgeInputSlot[e]];
+            edge.OutputNode = (void*)(intptr_t)graph.MakeNodeId(output_index);
+            edge.OutputSlot = graph.SlotIds[graph.NodeFirstSlot[output_index] + graph.NodeInputCount[output_index] + graph.EdgeOutputSlot[e]];
+            edges.push_back(edge);
+        }
+    }
+    ImNodes::Connections(edges.data(), (int)edges.size());
+}
+
+struct FrameStats
+{
+    double TimeMs = 0;
+    int Vertices = 0;
+    int Indices = 0;
+    size_t Allocations = 0;
+    size_t AllocatedBytes = 0;
+};
+
+struct BenchScene
+{
+    BenchApi Api = BenchApiCore;
+    ImNodes::Graph Graph;
+    ImNodes::CanvasState Canvas;
+    std::vector<ImNodes::ConnectionDesc> Edges;
+    char Title[64]{};
+    /// Scenes render into separate windows, so that they do not share window state storage.
+    char WindowName[80]{};
+};
+
+static FrameStats RenderFrame(BenchScene& scene, AllocationCounter& allocations)
+{
+    FrameStats stats;
+    size_t allocation_count = allocations.Count;
+    size_t allocated_bytes = allocations.Bytes;
+    Clock::time_point start = Clock::now();
+
+    ImGui::NewFrame();
+    ImGui::SetNextWindowPos(ImVec2{0, 0});
+    ImGui::SetNextWindowSize(display_size);
+    if (ImGui::Begin(scene.WindowName, nullptr, ImGuiWindowFlags_NoTitleBar | ImGuiWindowFlags_NoResize | ImGuiWindowFlags_NoMove |
+        ImGuiWindowFlags_NoScrollbar | ImGuiWindowFlags_NoScrollWithMouse | ImGuiWindowFlags_NoSavedSettings))
+    {
+        if (scene.Api == BenchApiEz)
+        {
+            ImNodes::Ez::BeginCanvas();
+            ImNodes::RenderGraph(scene.Graph);
+            ImNodes::Ez::EndCanvas();
+        }
+        else
+        {
+            ImNodes::BeginCanvas(&scene.Canvas);
+            RenderCoreGraph(scene.Graph, scene.Edges);
+            ImNodes::EndCanvas();
+        }
+    }
+    ImGui::End();
+    ImGui::Render();
+
+    stats.TimeMs = ElapsedMs(start);
+    ImDrawData* draw_data = ImGui::GetDrawData();
+    stats.Vertices = draw_data->TotalVtxCount;
+    stats.Indices = draw_data->TotalIdxCount;
+    stats.Allocations = allocations.Count - allocation_count;
+    stats.AllocatedBytes = allocations.Bytes - allocated_bytes;
+    return stats;
+}
+
+/// Set when canvas allocated memory while rendering an unchanged graph.
+static bool steady_state_allocated = false;
+
+static void RunScene(BenchScene& scene, int frames, AllocationCounter& allocations)
+{
+    ImGuiIO& io = ImGui::GetIO();
+    ImNodes::CanvasState& canvas = scene.Api == BenchApiEz ? ImNodes::Ez::GetState() : scene.Canvas;
+
+    for (int phase = 0; phase < BenchPhaseMax; phase++)
+    {
+        canvas.Zoom = 1.0f;
+        canvas.Offset = ImVec2{};
+
+        // Warm up with idle input, so that caches and slot positions are populated and previous phase input is released.
+        for (int frame = 0; frame < 3; frame++)
+        {
+            ScriptInput(io, BenchPhaseIdle, frame, 3);
+            RenderFrame(scene, allocations);
+        }
+
+        FrameStats total, worst;
+        int canvas_allocations = 0;
+        for (int frame = 0; frame < frames; frame++)
+        {
+            ScriptInput(io, (BenchPhase)phase, frame, frames);
+            FrameStats stats = RenderFrame(scene, allocations);
+            canvas_allocations += ImNodes::GetCanvasStats(&canvas).Allocations;
+            total.TimeMs += stats.TimeMs;
+            total.Vertices += stats.Vertices;
+            total.Indices += stats.Indices;
+            total.Allocations += stats.Allocations;
+            total.AllocatedBytes += stats.AllocatedBytes;
+            worst.TimeMs = ImMax(worst.TimeMs, stats.TimeMs);
+        }
+
+        printf("%-28s %-13s %-10s %9.3f %9.3f %9d %9d %9.1f %11.1f\n", scene.Title, api_names[scene.Api],
+            phase_names[phase], total.TimeMs / frames, worst.TimeMs, total.Vertices / frames, total.Indices / frames,
+            (double)total.Allocations / frames, (double)total.AllocatedBytes / frames);
+
+        if (phase == BenchPhaseIdle && canvas_allocations > 0)
+        {
+            fprintf(stderr, "%s %s: canvas made %d allocations while graph did not change\n", scene.Title,
+                api_names[scene.Api], canvas_allocations);
+            steady_state_allocated = true;
+        }
+    }
+}
+
+/// Compares curve kernels of ImNodes with equivalent ImGui code: fixed segment count tessellation as done by
+/// ImDrawList::PathBezierCubicCurveTo() and closest point search of ImBezierCubicClosestPoint().
+static void RunCurveBench()
+{
+    const int curve_count = 100000;
+    const int num_segments = 32;
+    std::vector<ImVec2> curves(curve_count * 4);
+    Random rng(1);
+    for (ImVec2& p : curves)
+        p = ImVec2{rng.Range(0.0f, 1920.0f), rng.Range(0.0f, 1080.0f)};
+    std::vector<ImVec2> points(num_segments + 1);
+    ImVec2 mouse_pos = display_size * 0.5f;
+    float sink = 0.0f;
+
+    Clock::time_point start = Clock::now();
+    for (int i = 0; i < curve_count; i++)
+    {
+        const ImVec2* p = &curves[i * 4];
+        points[0] = p[0];
+        for (int s = 1; s <= num_segments; s++)
+            points[s] = ImBezierCubicCalc(p[0], p[1], p[2], p[3], (float)s / num_segments);
+        sink += points[num_segments / 2].x;
+    }
+    double imgui_tessellate = ElapsedMs(start);
+
+    start = Clock::now();
+    for (int i = 0; i < curve_count; i++)
+    {
+        ImNodes::BezierCubicTessellate(&curves[i * 4], num_segments, points.data());
+        sink += points[num_segments / 2].x;
+    }
+    double imnodes_tessellate = ElapsedMs(start);
+
+    start = Clock::now();
+    for (int i = 0; i < curve_count; i++)
+    {
+        const ImVec2* p = &curves[i * 4];
+        ImVec2 closest = ImBezierCubicClosestPoint(p[0], p[1], p[2], p[3], mouse_pos, num_segments);
+        sink += ImLengthSqr(closest - mouse_pos);
+    }
+    double imgui_distance = ElapsedMs(start);
+
+    start = Clock::now();
+    for (int i = 0; i < curve_count; i++)
+    {
+        ImNodes::BezierCubicTessellate(&curves[i * 4], num_segments, points.data());
+        sink += ImNodes::PolylineDistanceSqr(points.data(), (int)points.size(), mouse_pos);
+    }
+    double imnodes_distance = ElapsedMs(start);
+
+    printf("\n%d curves, %d segments (checksum %g)\n", curve_count, num_segments, (double)sink);
+    printf("%-28s %9s %9s\n", "curve kernel", "imgui ms", "imnodes ms");
+    printf("%-28s %9.3f %9.3f\n", "tessellate", imgui_tessellate, imnodes_tessellate);
+    printf("%-28s %9.3f %9.3f\n", "distance to curve", imgui_distance, imnodes_distance);
+}
+
+/// Computes layout of a graph and prints time it took.
+static void TimeLayout(const char* title, const std::vector<ImVec2>& sizes, const std::vector<ImNodes::Layout::Edge>& edges)
+{
+    std::vector<ImVec2> positions(sizes.size());
+    Clock::time_point start = Clock::now();
+    ImNodes::Layout::Compute(sizes.data(), (int)sizes.size(), edges.data(), (int)edges.size(), positions.data());
+    double time = ElapsedMs(start);
+    printf("%-28s %9d %9.3f\n", title, (int)edges.size(), time);
+}
+
+/// Lays out generated graphs, which are acyclic, and graphs of the same size with twice as many random edges, which have
+/// many cycles.
+static void RunLayoutBench(int max_nodes)
+{
+    printf("\n%-28s %9s %9s\n", "layout", "edges", "ms");
+    for (int node_count = 1000; node_count <= ImMin(max_nodes, 10000); node_count *= 10)
+    {
+        ImNodes::Graph graph;
+        GenerateGraph(graph, node_count, 4, (ImU32)node_count);
+        std::vector<ImVec2> sizes(node_count);
+        std::vector<ImNodes::Layout::Edge> edges;
+        for (int i = 0; i < graph.GetNodeCapacity(); i++)
+        {
+            ImNodes::GraphNodeId node = graph.GetNodeAt(i);
+            int slot_count = ImMax(graph.GetInputSlotCount(node), graph.GetOutputSlotCount(node));
+            sizes[i] = ImVec2{180.0f, 40.0f + 20.0f * slot_count};
+            for (ImNodes::GraphEdgeId e = graph.GetFirstOutputEdge(node); e != 0; e = graph.GetNextOutputEdge(e))
+            {
+                ImNodes::Layout::Edge edge;
+                edge.OutputNode = i;
+                edge.InputNode = graph.GetNodeIndex(graph.GetEdgeInputNode(e));
+                edges.push_back(edge);
+            }
+        }
+
+        char title[64];
+        snprintf(title, sizeof(title), "%d nodes", node_count);
+        TimeLayout(title, sizes, edges);
+
+        Random rng((ImU32)node_count);
+        edges.resize(node_count * 2);
+        for (ImNodes::Layout::Edge& edge : edges)
+        {
+            edge.OutputNode = rng.Range(0, node_count - 1);
+            edge.InputNode = rng.Range(0, node_count - 1);
+        }
+        snprintf(title, sizeof(title), "%d nodes, cyclic", node_count);
+        TimeLayout(title, sizes, edges);
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    int max_nodes = argc > 1 ? atoi(argv[1]) : 100000;
+    int frames = argc > 2 ? atoi(argv[2]) : 30;
+    if (max_nodes <= 0 || frames <= 0)
+    {
+        fprintf(stderr, "Usage: %s [max_nodes] [frames_per_phase]\n", argv[0]);
+        return 1;
+    }
+
+    AllocationCounter allocations;
+    ImGui::SetAllocatorFunctions(&CountingAlloc, &CountingFree, &allocations);
+    ImNodes::EnableAllocationCounter();
+    ImGui::CreateContext();
+
+    // No rendering backend. Font atlas still must be built and renderer is assumed to support large meshes.
+    ImGuiIO& io = ImGui::GetIO();
+    io.IniFilename = nullptr;
+    io.DisplaySize = display_size;
+    io.DeltaTime = 1.0f / 60.0f;
+    io.BackendFlags |= ImGuiBackendFlags_RendererHasVtxOffset;
+    unsigned char* pixels;
+    int width, height;
+    io.Fonts->GetTexDataAsRGBA32(&pixels, &width, &height);
+
+    printf("%-28s %-13s %-10s %9s %9s %9s %9s %9s %11s\n", "graph", "api", "phase", "avg ms", "max ms", "vertices",
+        "indices", "allocs", "alloc bytes");
+    const int fan_outs[] = {1, 4};
+    for (int node_count = 1000; node_count <= max_nodes; node_count *= 10)
+    {
+        for (int fan_out : fan_outs)
+        {
+            for (int api = 0; api < BenchApiMax; api++)
+            {
+                BenchScene scene;
+                scene.Api = (BenchApi)api;
+                scene.Canvas.RedrawCache = scene.Api == BenchApiCoreCached;
+                scene.Canvas.DeferredCurves = scene.Api == BenchApiCoreDeferred;
+                GenerateGraph(scene.Graph, node_count, fan_out, (ImU32)node_count);
+                snprintf(scene.Title, sizeof(scene.Title), "%d nodes, %d edges", node_count, scene.Graph.GetEdgeCount());
+                snprintf(scene.WindowName, sizeof(scene.WindowName), "%s##%d", scene.Title, api);
+
+                // Fresh context, so that Ez state of previous scene does not affect results.
+                ImNodes::Ez::Context* context = scene.Api == BenchApiEz ? ImNodes::Ez::CreateContext() : nullptr;
+#ifdef IMNODES_PROFILE_CHROME_TRACE
+                // Trace of the smallest graph is enough to see where time goes and keeps trace file small.
+                bool trace = node_count == 1000 && fan_out == fan_outs[0];
+                if (trace)
+                    ImNodes::BeginProfileTrace();
+#endif
+                RunScene(scene, frames, allocations);
+#ifdef IMNODES_PROFILE_CHROME_TRACE
+                if (trace)
+                {
+                    char path[64];
+                    snprintf(path, sizeof(path), "ImNodesBench-%s.json", api_names[scene.Api]);
+                    ImNodes::EndProfileTrace(path);
+                }
+#endif
+                if (context != nullptr)
+                    ImNodes::Ez::FreeContext(context);
+            }
+        }
+    }
+
+    RunCurveBench();
+    RunLayoutBench(max_nodes);
+
+    ImGui::DestroyContext();
+    return steady_state_allocated ? 1 : 0;
+}
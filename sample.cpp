@@ -144,36 +144,37 @@ void ShowDemoWindow(bool*)
 
                 // Render output nodes first (order is important)
                 ImNodes::Ez::OutputSlots(node->OutputSlots.data(), node->OutputSlots.size());
+            }
+            // Node rendering is done. This call will render node background based on size of content inside node.
+            ImNodes::Ez::EndNode();
 
-                // Store new connections when they are created
-                Connection new_connection;
-                if (ImNodes::GetNewConnection(&new_connection.InputNode, &new_connection.InputSlot,
-                                              &new_connection.OutputNode, &new_connection.OutputSlot))
-                {
-                    ((MyNode*) new_connection.InputNode)->Connections.push_back(new_connection);
-                    ((MyNode*) new_connection.OutputNode)->Connections.push_back(new_connection);
-                }
+            // Store new connections when they are created
+            Connection new_connection;
+            if (ImNodes::GetNewConnection(&new_connection.InputNode, &new_connection.InputSlot,
+                                          &new_connection.OutputNode, &new_connection.OutputSlot))
+            {
+                ((MyNode*) new_connection.InputNode)->Connections.push_back(new_connection);
+                ((MyNode*) new_connection.OutputNode)->Connections.push_back(new_connection);
+            }
 
-                // Render output connections of this node
-                for (const Connection& connection : node->Connections)
-                {
-                    // Node contains all it's connections (both from output and to input slots). This means that multiple
-                    // nodes will have same connection. We render only output connections and ensure that each connection
-                    // will be rendered once.
-                    if (connection.OutputNode != node)
-                        continue;
+            // Render output connections of this node. This is done even when node is not visible, because node on the
+            // other end of connection may be visible.
+            for (const Connection& connection : node->Connections)
+            {
+                // Node contains all it's connections (both from output and to input slots). This means that multiple
+                // nodes will have same connection. We render only output connections and ensure that each connection
+                // will be rendered once.
+                if (connection.OutputNode != node)
+                    continue;
 
-                    if (!ImNodes::Connection(connection.InputNode, connection.InputSlot, connection.OutputNode,
+                if (!ImNodes::Ez::Connection(connection.InputNode, connection.InputSlot, connection.OutputNode,
                                              connection.OutputSlot))
-                    {
-                        // Remove deleted connections
-                        ((MyNode*) connection.InputNode)->DeleteConnection(connection);
-                        ((MyNode*) connection.OutputNode)->DeleteConnection(connection);
-                    }
+                {
+                    // Remove deleted connections
+                    ((MyNode*) connection.InputNode)->DeleteConnection(connection);
+                    ((MyNode*) connection.OutputNode)->DeleteConnection(connection);
                 }
             }
-            // Node rendering is done. This call will render node background based on size of content inside node.
-            ImNodes::Ez::EndNode();
 
             if (node->Selected && ImGui::IsKeyPressedMap(ImGuiKey_Delete) && ImGui::IsWindowFocused())
             {